@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+/* Sizes are rounded up to a multiple of the alignment */
+#define ARENA_ALIGN 16
+#define ARENA_MAX_SIZE 128
+#define ARENA_CLASSES (ARENA_MAX_SIZE / ARENA_ALIGN)
+
+typedef struct ArenaStats {
+    size_t allocs;
+    size_t frees;
+    /* Total size of the allocated cells */
+    size_t bytes;
+    size_t chunks;
+} ArenaStats;
+
+typedef struct ArenaChunk ArenaChunk;
+
+/*
+ * Allocator of small objects. Cells are carved from large chunks by bumping a
+ * pointer, and freed cells are kept in a list per size, from which they are
+ * reused. Chunks are released all at once by arena_deinit().
+ *
+ * A zeroed Arena is empty and ready for use.
+ */
+typedef struct Arena {
+    ArenaChunk *chunks;
+    char *ptr;
+    char *end;
+    void *free_lists[ARENA_CLASSES];
+    ArenaStats stats;
+} Arena;
+
+void arena_init(Arena *self);
+void arena_deinit(Arena *self);
+/* Allocate a zeroed cell of at most ARENA_MAX_SIZE bytes */
+void *arena_alloc(Arena *self, size_t size);
+/* size must be the same as the one passed to arena_alloc() */
+void arena_free(Arena *self, void *ptr, size_t size);
@@ -9,6 +9,7 @@
 
 #include "lexer.h"
 #include "strbuf.h"
+#include "symbol.h"
 #include "vector.h"
 
 #include <stdint.h>
@@ -25,27 +26,42 @@ typedef enum AstNodeKind {
     AST_NODE_GROUPING,
     AST_NODE_FN_CALL,
     AST_NODE_SUBSCRIPT,
+    AST_NODE_SLICE,
+    AST_NODE_FIELD,
     AST_NODE_BLOCK,
     AST_NODE_IF,
     AST_NODE_WHILE,
     AST_NODE_FOR,
+    AST_NODE_FOR_EACH,
     AST_NODE_INT_TYPE,
     AST_NODE_STRING_TYPE,
     AST_NODE_VOID_TYPE,
     AST_NODE_OPTION_TYPE,
     AST_NODE_LIST_TYPE,
+    AST_NODE_MAP_TYPE,
+    AST_NODE_STRUCT_TYPE,
     AST_NODE_VAR_DECL,
     AST_NODE_PARAM_DECL,
     AST_NODE_FN_DECL,
+    AST_NODE_STRUCT_DECL,
     AST_NODE_RETURN,
     AST_NODE_BREAK,
     AST_NODE_CONTINUE,
     AST_NODE_NIL
 } AstNodeKind;
 
+struct Type;
+
+/* Names of the hidden variables of a for-each loop, which can't be written as
+ * identifiers */
+#define AST_FOR_EACH_KEYS "(keys)"
+#define AST_FOR_EACH_INDEX "(index)"
+
 typedef struct AstNode {
     AstNodeKind kind;
     Token tok;
+    /* Type of a type node or an expression, resolved by semantic checker */
+    struct Type *type;
 
     union {
         union {
@@ -54,7 +70,10 @@ typedef struct AstNode {
         } literal;
 
         struct {
-            StrBuf str;
+            Symbol name;
+            /* Address of the variable, resolved by semantic checker */
+            int depth;
+            int slot;
         } ident;
 
         struct {
@@ -87,6 +106,21 @@ typedef struct AstNode {
             struct AstNode *left;
         } subscript;
 
+        struct {
+            struct AstNode *left;
+            /* The bounds can be omitted, then they're NULL */
+            struct AstNode *start;
+            struct AstNode *end;
+        } slice;
+
+        struct {
+            struct AstNode *left;
+            struct AstNode *name;
+            /* Index of the field in the struct, resolved by semantic
+             * checker */
+            int idx;
+        } field;
+
         struct {
             Vector nodes; /* Vector<AstNode *> */
         } block;
@@ -109,6 +143,17 @@ typedef struct AstNode {
             struct AstNode *body;
         } kw_for;
 
+        struct {
+            /* Param declaration of the key variable */
+            struct AstNode *var;
+            struct AstNode *map;
+            struct AstNode *body;
+            /* Address of the hidden list of keys, followed by the index in
+             * the next slot, resolved by semantic checker */
+            int depth;
+            int slot;
+        } kw_for_each;
+
         struct {
             struct AstNode *type;
         } opt_type;
@@ -119,6 +164,15 @@ typedef struct AstNode {
             struct AstNode *size;
         } list_type;
 
+        struct {
+            struct AstNode *key;
+            struct AstNode *value;
+        } map_type;
+
+        struct {
+            Symbol name;
+        } struct_type;
+
         struct {
             struct AstNode *type;
             struct AstNode *name;
@@ -137,6 +191,11 @@ typedef struct AstNode {
             struct AstNode *body;
         } fn_decl;
 
+        struct {
+            struct AstNode *name;
+            Vector fields; /* Vector<AstNode *>, param declarations */
+        } struct_decl;
+
         struct {
             struct AstNode *expr;
         } kw_return;
@@ -145,6 +204,8 @@ typedef struct AstNode {
 
 AstNode *astnode_new(AstNodeKind kind, const Token *tok);
 void astnode_destroy(AstNode *self);
+/* Deep copy of an expression, returns NULL for other nodes */
+AstNode *astnode_clone(const AstNode *self);
 
 typedef struct Ast {
     Vector nodes; /* Vector<AstNode *> */
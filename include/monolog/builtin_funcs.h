@@ -12,9 +12,7 @@
 #include "type.h"
 
 #define DECLARE_BUILTIN(_name)                                                 \
-    ExprResult builtin_##_name(                                                \
-        Interpreter *self, Value *args, const AstNode *node                    \
-    )
+    Value builtin_##_name(Interpreter *self, Value *args)
 
 DECLARE_BUILTIN(print);
 DECLARE_BUILTIN(println);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include "src_info.h"
+#include "strbuf.h"
+#include "symbol.h"
+#include "type.h"
+#include "vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum OpCode {
+    OP_INT,          /* push ints[arg] */
+    OP_STRING,       /* push the constant strings[arg] */
+    OP_NIL,          /* push nil */
+    OP_GET_VAR,      /* push the variable at var_refs[arg] */
+    OP_POP,          /* discard the top of the stack, ending the statement */
+    OP_UNARY,        /* apply prefix operator arg (TokenKind) */
+    OP_BINARY,       /* apply binary operator arg (TokenKind) */
+    OP_SUFFIX,       /* apply suffix operator arg (TokenKind) */
+    OP_ASSIGN,       /* assign the top of the stack to the lvalue below it */
+    OP_APPEND,       /* s = s + e: append the string on top to the string
+                        variable below it */
+    OP_SUBSCRIPT,    /* index the container, arg is 1 if it'll be assigned */
+    OP_SLICE,        /* slice the container with the bounds on top, arg is 1
+                        if the end was omitted */
+    OP_FIELD,        /* replace the struct on top with its field arg */
+    OP_FIELD_MUT,    /* the same, but the struct is made unique first, as
+                        the field will be assigned */
+    OP_CALL,         /* call the function at call_sites[arg] */
+    OP_TAIL_CALL,    /* call the current function at call_sites[arg] again,
+                        reusing its frame, and return the result */
+    OP_JUMP,         /* jump to arg */
+    OP_JUMP_IF_FALSE, /* pop the condition, ending the statement, and jump
+                         to arg if it's zero */
+    OP_JUMP_IF_TRUE, /* pop the condition, ending the statement, and jump
+                        to arg if it's nonzero */
+    OP_AND,          /* pop the left operand of &&, if it's zero push 0 and
+                        jump to arg */
+    OP_OR,           /* pop the left operand of ||, if it's nonzero push 1
+                        and jump to arg */
+    OP_BOOL,         /* normalize the int on top to 0 or 1 */
+    OP_ENTER_SCOPE,  /* open a new block scope */
+    OP_LEAVE_SCOPE,  /* close arg block scopes */
+    OP_LIST_SIZE,    /* check that the list size on top isn't negative */
+    OP_MAP_KEYS,     /* replace the map on top with a list of its keys */
+    OP_VAR_DECL,     /* declare the variable var_decls[arg], ending the
+                        statement */
+    OP_FN_DECL,      /* declare the function fns[arg] */
+    OP_RETURN,       /* return from function, arg is 1 if it has a value */
+    OP_INVALID,      /* report an invalid expression */
+    OP_END           /* stop execution */
+} OpCode;
+
+typedef struct Instr {
+    OpCode op;
+    int32_t arg;
+} Instr;
+
+/* Address of a variable: scope depth and slot in it */
+typedef struct VarRef {
+    int32_t depth;
+    int32_t slot;
+    int32_t name; /* index in Chunk.names, used in error messages */
+} VarRef;
+
+/* Function call with the callee cached after the first lookup */
+typedef struct CallSite {
+    int32_t name; /* index in Chunk.names */
+    /* Valid only while it matches Environment.fn_epoch */
+    uint32_t epoch;
+    struct Function *fn;
+} CallSite;
+
+typedef struct VarDeclInfo {
+    Type *type;
+    int32_t name; /* index in Chunk.names */
+    int32_t slot; /* slot in the current scope */
+    bool has_size;
+    bool has_init;
+} VarDeclInfo;
+
+/*
+ * Immutable literals shared by all chunks run by one interpreter. The pool
+ * outlives the chunks, because values bound to variables keep pointing to it.
+ */
+typedef struct ConstPool {
+    Vector strings; /* Vector<StrBuf *> */
+} ConstPool;
+
+/* Compiled code of a program or a function body */
+typedef struct Chunk {
+    Vector code; /* Vector<Instr> */
+    /* Position in source for each instruction, used for runtime errors */
+    Vector src_infos; /* Vector<SourceInfo> */
+
+    Vector ints; /* Vector<int64_t> */
+    Vector strings; /* Vector<StrBuf *>, owned by ConstPool */
+    Vector names; /* Vector<Symbol> */
+    Vector var_refs; /* Vector<VarRef> */
+    Vector call_sites; /* Vector<CallSite> */
+    Vector var_decls; /* Vector<VarDeclInfo> */
+    /* Functions declared in this chunk. An entry is set to NULL when the
+     * declaration is executed and the function is moved to environment. */
+    Vector fns; /* Vector<Function *> */
+} Chunk;
+
+void const_pool_init(ConstPool *self);
+void const_pool_deinit(ConstPool *self);
+StrBuf *const_pool_add_string(ConstPool *self, const char *str, size_t len);
+
+void chunk_init(Chunk *self);
+void chunk_deinit(Chunk *self);
+size_t chunk_emit(Chunk *self, OpCode op, int32_t arg, SourceInfo src_info);
+int32_t chunk_add_int(Chunk *self, int64_t i);
+int32_t chunk_add_string(Chunk *self, StrBuf *str);
+int32_t chunk_add_name(Chunk *self, Symbol name);
+int32_t chunk_add_var_ref(Chunk *self, int depth, int slot, Symbol name);
+int32_t chunk_add_call_site(Chunk *self, Symbol name);
+void chunk_dump(const Chunk *self, FILE *out);
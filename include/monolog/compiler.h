@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include "ast.h"
+#include "bytecode.h"
+#include "type.h"
+#include "vector.h"
+
+/* Translates a semantically checked AST into bytecode for the interpreter */
+typedef struct Compiler {
+    TypeSystem *types;
+    /* String literals are stored here, chunks only refer to them */
+    ConstPool *consts;
+    Chunk *chunk;
+    /* Number of block scopes opened inside the current chunk */
+    int scope_depth;
+    /* Declaration of the function being compiled, NULL at top level */
+    const AstNode *fn;
+    Vector loops; /* Vector<LoopInfo> */
+} Compiler;
+
+void compiler_init(Compiler *self, TypeSystem *types, ConstPool *consts);
+void compiler_deinit(Compiler *self);
+void compiler_compile(Compiler *self, const Ast *ast, Chunk *chunk);
+void compiler_compile_expr(Compiler *self, const AstNode *node, Chunk *chunk);
@@ -9,6 +9,7 @@
 
 #include "lexer.h"
 #include "src_info.h"
+#include "symbol.h"
 #include "type.h"
 
 typedef enum DiagnosticKind {
@@ -34,6 +35,17 @@ typedef enum DiagnosticKind {
     DIAGNOSTIC_RETURN_OUTSIDE_FUNCTION,
     DIAGNOSTIC_VOID_RETURN,
     DIAGNOSTIC_VOID_VAR,
+    DIAGNOSTIC_EXPECTED_MAP,
+    DIAGNOSTIC_BAD_MAP_KEY_TYPE,
+    DIAGNOSTIC_VOID_MAP_VALUE,
+    DIAGNOSTIC_UNKNOWN_TYPE,
+    DIAGNOSTIC_STRUCT_REDEFINITION,
+    DIAGNOSTIC_STRUCT_BAD_PLACE,
+    DIAGNOSTIC_RECURSIVE_STRUCT,
+    DIAGNOSTIC_FIELD_REDECLARATION,
+    DIAGNOSTIC_VOID_FIELD,
+    DIAGNOSTIC_EXPECTED_STRUCT,
+    DIAGNOSTIC_NO_SUCH_FIELD,
 } DiagnosticKind;
 
 typedef struct DiagnosticMessage {
@@ -63,15 +75,15 @@ typedef struct DiagnosticMessage {
         } type_mismatch;
 
         struct {
-            char *name;
+            Symbol name;
         } undef_sym;
 
         struct {
-            char *name;
+            Symbol name;
         } param_redecl;
 
         struct {
-            char *name;
+            Symbol name;
         } fn_redef;
 
         struct {
@@ -87,6 +99,19 @@ typedef struct DiagnosticMessage {
         struct {
             Type *found;
         } bad_index_type;
+
+        struct {
+            Symbol name;
+        } struct_def;
+
+        struct {
+            Symbol name;
+        } field_redecl;
+
+        struct {
+            Type *type;
+            Symbol name;
+        } no_field;
     };
 } DiagnosticMessage;
 
@@ -15,9 +15,12 @@
 #include "vector.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct Environment {
-    Vector scopes; /* Vector<Scope> */
+    Vector scopes; /* Vector<Scope *> */
+    /* Scopes left earlier, which are reused instead of allocating new ones */
+    Vector free_scopes; /* Vector<Scope *> */
     HashMap funcs; /* HashMap<char *, Function *> */
     Scope *global_scope;
     Scope *caller_scope;
@@ -25,12 +28,36 @@ typedef struct Environment {
     Scope *old_scope;
     Function *curr_fn;
     Function *old_fn;
+    /* Index of the scope, from which the depth of local variables is counted:
+     * the scope of the current function or the first one after global. */
+    size_t frame_base;
+    /* Changed whenever a function is added or removed, so cached lookups of
+     * functions become stale */
+    uint32_t fn_epoch;
 } Environment;
 
+/* Get the variable at address resolved by semantic checker */
+static inline Variable *
+env_get_var(const Environment *self, int depth, int slot) {
+    const Scope *scope =
+        depth == VAR_GLOBAL_DEPTH
+            ? self->global_scope
+            : ((Scope *const *) self->scopes.data)[self->frame_base +
+                                                   (size_t) depth];
+
+    if ((size_t) slot >= scope->slots.len) {
+        return NULL;
+    }
+
+    return ((Variable *const *) scope->slots.data)[slot];
+}
+
 void env_init(Environment *self, TypeSystem *types);
 void env_deinit(Environment *self);
-Variable *env_find_var(const Environment *self, const char *name);
-Function *env_find_fn(const Environment *self, const char *name);
+Variable *env_find_var(const Environment *self, Symbol name);
+Variable *
+env_resolve_var(const Environment *self, Symbol name, int *depth);
+Function *env_find_fn(const Environment *self, Symbol name);
 void env_reset(Environment *self);
 Scope *env_enter_scope(Environment *self);
 void env_leave_scope(Environment *self);
@@ -41,3 +68,4 @@ void env_restore_caller(Environment *self);
 void env_add_fn(Environment *self, Function *fn);
 void env_add_local_var(Environment *self, Variable *var);
 void env_add_global_var(Environment *self, Variable *var);
+void env_bind_var(Environment *self, Variable *var);
@@ -7,7 +7,6 @@
 
 #pragma once
 
-#include "ast.h"
 #include "variable.h"
 #include "value.h"
 
@@ -17,17 +16,48 @@ typedef enum ExprResultKind {
     EXPR_VALUE,
     EXPR_VAR,
     EXPR_REF,
-    EXPR_CHAR_REF
+    EXPR_CHAR_REF,
+    EXPR_INT_REF,
+    EXPR_OPT_REF,
+    EXPR_MAP_SLOT,
+    EXPR_STRUCT_REF
 } ExprResultKind;
 
 typedef struct ExprResult {
     ExprResultKind kind;
-    const AstNode *node;
 
     union {
         Value val;
         Variable *var;
-        Value *ref;
+
+        struct {
+            Value *ref;
+            /* List holding the referenced element, or NULL */
+            Vector *ref_list;
+        };
+
         char *char_ref;
+        /* Element of an [int] list */
+        Int *int_ref;
+        /* Present option whose inner value is referred to */
+        Value *opt_ref;
+
+        /* Element of a map which is about to be assigned. It's looked up
+         * only then, since assigning nil removes the key instead. */
+        struct {
+            ValueMap *map;
+            /* Payload of the key, of the key type of the map */
+            union {
+                Int i;
+                StrBuf *s;
+            } key;
+        } map_slot;
+
+        /* Element of a list of structs, whose fields are stored in the list
+         * itself. It becomes a struct of its own when its value is taken. */
+        struct {
+            Type *type;
+            Value *fields;
+        } struct_ref;
     };
 } ExprResult;
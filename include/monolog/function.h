@@ -7,29 +7,30 @@
 
 #pragma once
 
-#include "ast.h"
-#include "expr_result.h"
+#include "bytecode.h"
+#include "symbol.h"
 #include "type.h"
+#include "value.h"
 #include "vector.h"
 
 typedef struct FnParam {
     Type *type;
-    char *name;
+    Symbol name;
 } FnParam;
 
 typedef struct Interpreter Interpreter;
-typedef ExprResult (*FnBuiltin)(Interpreter *self, Value *args, const AstNode *node);
+typedef Value (*FnBuiltin)(Interpreter *self, Value *args);
 
 typedef struct Function {
     Type *type;
-    char *name;
+    Symbol name;
     Vector params; /* Vector<FnParam> */
-    bool free_body;
     bool is_builtin;
 
     union {
         FnBuiltin builtin;
-        AstNode *body;
+        /* Compiled body, owned by the function */
+        Chunk *chunk;
     };
 } Function;
 
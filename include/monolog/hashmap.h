@@ -8,11 +8,15 @@
 #pragma once
 
 /*
- * Simple implementation of a hash table:
+ * Hash table in the style of Swiss tables:
  *   - does not copy anything - keys and values are pointers
- *   - open addressing for bucket storage
- *   - linear probing for finding an available bucket
- *   - FNV-1a as a hash function
+ *   - open addressing, slots are probed in groups of HASHMAP_GROUP_WIDTH
+ *   - a control byte per slot holds 7 bits of the key's hash, so a whole group
+ *     is matched at once (with SSE2 where available) before comparing keys
+ *   - the full hash and the length of each key are cached in its bucket
+ *   - FNV-1a as a hash function, which the caller can compute in advance
+ *   - keys are compared by address first, so interned keys (see symbol.h)
+ *     are usually found without comparing the strings
  */
 
 #include <stdbool.h>
@@ -21,27 +25,51 @@
 
 /* OPTIMIZATION: it's better to use powers of 2 */
 #define HASHMAP_DEFAULT_CAP 256
+#define HASHMAP_GROUP_WIDTH 16
 
 typedef uint32_t HashType;
 
 typedef struct Bucket {
     const char *key;
     void *value;
+    HashType hash;
+    uint32_t len;
 } Bucket;
 
 typedef struct HashMap {
     Bucket *buckets;
+    /* Control bytes of the buckets, followed by a copy of the first group, so
+     * a group starting at any bucket can be loaded at once */
+    uint8_t *ctrl;
     size_t size;
+    /* Number of removed buckets, which still take part in probing */
+    size_t deleted;
     size_t cap;
 } HashMap;
 
+/* FNV-1a hash of the first len bytes of key */
+HashType hashmap_hash(const char *key, size_t len);
+
 bool hashmap_init(HashMap *self);
+/* cap must be a power of 2, no less than HASHMAP_GROUP_WIDTH */
+bool hashmap_init_cap(HashMap *self, size_t cap);
 void hashmap_deinit(HashMap *self);
 bool hashmap_add(HashMap *self, const char *key, void *value);
 void hashmap_remove(HashMap *self, const char *key);
 void *hashmap_get(const HashMap *self, const char *key);
 void hashmap_clear(HashMap *self);
 
+/* Same as above, but hash must be hashmap_hash(key, len) */
+bool hashmap_add_hashed(
+    HashMap *self, const char *key, size_t len, HashType hash, void *value
+);
+void hashmap_remove_hashed(
+    HashMap *self, const char *key, size_t len, HashType hash
+);
+void *hashmap_get_hashed(
+    const HashMap *self, const char *key, size_t len, HashType hash
+);
+
 typedef struct HashMapIter {
     HashMap *map;
     Bucket *bucket;
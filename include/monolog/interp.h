@@ -8,18 +8,53 @@
 #pragma once
 
 #include "ast.h"
+#include "bytecode.h"
 #include "environment.h"
 #include "type.h"
 #include "value.h"
 
 #include <stdbool.h>
+#include <stddef.h>
+
+/* Number of nested calls allowed unless set otherwise */
+#define INTERP_DEFAULT_MAX_DEPTH 100000
+
+/* Saved state of the caller, restored when the callee returns */
+typedef struct CallFrame {
+    Chunk *chunk;
+    size_t ip;
+    size_t stack_base;
+    size_t scope_base;
+    size_t frame_base;
+    size_t pinned_base;
+    size_t temps_base;
+    Scope *scope;
+    Scope *caller_scope;
+    Function *fn;
+} CallFrame;
 
 typedef struct Interpreter {
     Environment env;
     TypeSystem *types;
+    /* Literals of the chunks run by the interpreter */
+    ConstPool consts;
 
     /* Temporary storage for function's arguments */
     Vector builtin_fn_args;
+    /* New parameters of a tail call, taken before the old ones are released */
+    Vector tail_params; /* Vector<Variable> */
+
+    Vector stack; /* Vector<ExprResult> */
+    Vector frames; /* Vector<CallFrame> */
+    /* Arguments passed by reference to the active calls */
+    Vector pinned; /* Vector<Value> */
+    /* Results of the current statement, released when it ends */
+    Vector temps; /* Vector<Value> */
+    /* Temporaries below it belong to the callers */
+    size_t temps_base;
+
+    /* Calls nested deeper than this fail with a stack overflow */
+    size_t max_depth;
 
     Ast *ast;
     int exit_code;
@@ -30,5 +65,7 @@ typedef struct Interpreter {
 
 void interp_init(Interpreter *self, Ast *ast, TypeSystem *types);
 void interp_deinit(Interpreter *self);
+int interp_run(Interpreter *self, Chunk *chunk);
+/* Compile the attached AST and run it */
 int interp_walk(Interpreter *self);
 Value interp_eval(Interpreter *self);
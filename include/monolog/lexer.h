@@ -21,6 +21,8 @@ typedef enum TokenKind {
     TOKEN_STRING_LIT,
     TOKEN_COMMA,
     TOKEN_SEMICOLON,
+    TOKEN_COLON,
+    TOKEN_DOT,
     TOKEN_LPAREN,
     TOKEN_RPAREN,
     TOKEN_LBRACKET,
@@ -60,7 +62,9 @@ typedef enum TokenKind {
     TOKEN_NIL,
     TOKEN_INT,
     TOKEN_VOID,
-    TOKEN_STRING
+    TOKEN_STRING,
+    TOKEN_MAP,
+    TOKEN_STRUCT
 } TokenKind;
 
 const char *token_kind_to_str(TokenKind kind);
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include "ast.h"
+#include "hashmap.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Number of AST nodes an inlined call may expand to */
+#define INLINE_MAX_COST 32
+#define INLINE_MAX_PARAMS 8
+
+/* Rewrites a semantically checked AST before it's compiled: constant int and
+ * string subexpressions are folded into literals, branches that can never
+ * be taken are removed and calls of small functions are inlined */
+typedef struct Optimizer {
+    /* Functions that return a single pure int expression */
+    HashMap inline_fns; /* HashMap<AstNode *> */
+    /* The statement being optimized is not nested in another one, so it
+     * always runs */
+    bool top_level;
+
+    /* Number of expressions replaced by literals */
+    size_t folded;
+    /* Number of if and while statements replaced by one of their branches */
+    size_t pruned;
+    /* Number of calls replaced by the body of the function */
+    size_t inlined;
+} Optimizer;
+
+void optimizer_init(Optimizer *self);
+void optimizer_deinit(Optimizer *self);
+void optimizer_optimize(Optimizer *self, Ast *ast);
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include "arena.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Reference counted allocations. The counters are stored in a header placed
+ * right before the object, so the object itself is an ordinary struct. Small
+ * objects (strings, lists, boxes) are served from an arena.
+ */
+
+/* Allocate a zeroed object holding one reference */
+void *rc_alloc(size_t size);
+/* Free the object regardless of its references */
+void rc_free(void *obj);
+void rc_retain(void *obj);
+/* Returns true if the last reference was dropped and the object must be
+ * destroyed with rc_free() */
+bool rc_release(void *obj);
+bool rc_shared(const void *obj);
+/* Make the object immortal: it's never released and always shared */
+void rc_make_static(void *obj);
+/* Mark the object as a view: it borrows the buffer of another object, so it
+ * has to be copied before it's modified */
+void rc_make_view(void *obj);
+bool rc_is_view(const void *obj);
+
+/*
+ * A pinned object is aliased, so it must be copied instead of shared, and
+ * modified in place through any alias. Each pin has to be backed by its own
+ * reference, which doesn't count as sharing.
+ */
+void rc_pin(void *obj);
+void rc_unpin(void *obj);
+bool rc_pinned(const void *obj);
+
+/* Release the arena, all objects allocated from it become invalid */
+void rc_deinit(void);
+/* Allocations made from the arena so far */
+ArenaStats rc_stats(void);
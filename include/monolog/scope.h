@@ -10,17 +10,19 @@
 #include "hashmap.h"
 #include "variable.h"
 
+/* Containers of a scope are allocated on first use */
 typedef struct Scope {
+    /* Variables that can be looked up by name. At runtime only globals are
+     * registered here, locals are accessed by slot. */
     HashMap vars; /* HashMap<char *, Variable *> */
-    Vector values; /* Vector<Value *> */
-    Vector strings; /* Vector<StrBuf *> */
-    Vector lists; /* Vector<Vector<Value> *> */
+    /* Variables own their values, which are released with them */
+    Vector slots; /* Vector<Variable *> */
 } Scope;
 
 void scope_init(Scope *self);
 void scope_deinit(Scope *self);
 void scope_clear(Scope *self);
 void scope_add_var(Scope *self, Variable *var);
-Value *scope_new_value(Scope *self, Type *type);
-StrBuf *scope_new_string(Scope *self);
-Vector *scope_new_list(Scope *self);
+void scope_register_var(Scope *self, Variable *var);
+void scope_set_var(Scope *self, Variable *var);
+void scope_truncate(Scope *self, size_t len);
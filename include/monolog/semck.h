@@ -28,6 +28,6 @@ typedef struct SemChecker {
 void semck_init(SemChecker *self, TypeSystem *types);
 void semck_deinit(SemChecker *self);
 bool semck_check(
-    SemChecker *self, const Ast *ast, HashMap *vars, HashMap *funcs
+    SemChecker *self, Ast *ast, HashMap *vars, HashMap *funcs
 );
 void semck_reset(SemChecker *self);
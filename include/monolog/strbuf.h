@@ -10,11 +10,45 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/*
+ * Strings up to this length are stored inside of StrBuf without allocation,
+ * in place of the data pointer and the length.
+ */
+#define STRBUF_SSO_CAP (sizeof(char *) + sizeof(size_t) - 1)
+
+/* Use the accessors below, the fields depend on where the string is stored */
 typedef struct StrBuf {
-    char *data;
-    size_t len;
+    union {
+        struct {
+            char *data;
+            size_t len;
+        } heap;
+        char sso[STRBUF_SSO_CAP + 1];
+    };
+    /* Maximum length that fits into heap.data without reallocation, it's
+     * always bigger than STRBUF_SSO_CAP. Smaller values mean that the string
+     * is stored in sso and cap is its length instead. */
+    size_t cap;
 } StrBuf;
 
+static inline bool str_is_inline(const StrBuf *self) {
+    return self->cap <= STRBUF_SSO_CAP;
+}
+
+/* The null-terminated contents */
+static inline char *str_data(const StrBuf *self) {
+    return str_is_inline(self) ? (char *) self->sso : self->heap.data;
+}
+
+static inline size_t str_len(const StrBuf *self) {
+    return str_is_inline(self) ? self->cap : self->heap.len;
+}
+
+/* The terminating null character is not counted */
+static inline size_t str_cap(const StrBuf *self) {
+    return str_is_inline(self) ? STRBUF_SSO_CAP : self->cap;
+}
+
 bool str_init(StrBuf *self);
 bool str_init_n(StrBuf *self, size_t len);
 bool str_dup(StrBuf *self, const char *cstr);
@@ -24,3 +58,5 @@ bool str_cat(StrBuf *self, const StrBuf *src);
 bool str_set_cstr(StrBuf *self, const char *cstr);
 bool str_equal(const StrBuf *self, const StrBuf *str);
 bool str_resize(StrBuf *self, size_t n);
+bool str_reserve(StrBuf *self, size_t cap);
+bool str_shrink(StrBuf *self);
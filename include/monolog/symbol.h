@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#pragma once
+
+#include "hashmap.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Interned identifier. Every distinct name is stored once in a process-wide
+ * table, so two symbols are equal iff they are the same pointer. Symbols are
+ * NUL-terminated and stay valid until sym_table_deinit().
+ */
+typedef const char *Symbol;
+
+/* Stored right before the name of every symbol */
+typedef struct SymHeader {
+    HashType hash;
+    uint32_t len;
+} SymHeader;
+
+Symbol sym_intern(const char *str, size_t len);
+Symbol sym_intern_cstr(const char *str);
+/* Release all symbols, none of them may be used afterwards */
+void sym_table_deinit(void);
+
+/* hashmap_hash() of the name */
+static inline HashType sym_hash(Symbol sym) {
+    return ((const SymHeader *) sym - 1)->hash;
+}
+
+static inline size_t sym_len(Symbol sym) {
+    return ((const SymHeader *) sym - 1)->len;
+}
+
+/* Operations on maps keyed by symbols, which don't hash the names again */
+static inline bool sym_map_add(HashMap *map, Symbol key, void *value) {
+    return hashmap_add_hashed(map, key, sym_len(key), sym_hash(key), value);
+}
+
+static inline void sym_map_remove(HashMap *map, Symbol key) {
+    hashmap_remove_hashed(map, key, sym_len(key), sym_hash(key));
+}
+
+static inline void *sym_map_get(const HashMap *map, Symbol key) {
+    return hashmap_get_hashed(map, key, sym_len(key), sym_hash(key));
+}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "hashmap.h"
+#include "symbol.h"
 #include "vector.h"
 
 #include <stdbool.h>
@@ -19,9 +20,16 @@ typedef enum TypeId {
     TYPE_VOID,
     TYPE_LIST,
     TYPE_OPTION,
+    TYPE_MAP,
+    TYPE_STRUCT,
     TYPE_NIL
 } TypeId;
 
+typedef struct StructField {
+    Symbol name;
+    struct Type *type;
+} StructField;
+
 typedef struct Type {
     TypeId id;
     char *name;
@@ -29,12 +37,35 @@ typedef struct Type {
     union {
         struct {
             struct Type *type;
+            /* Runtime types of option values, which tell whether the value
+             * is present. Both are equal to the option type: the empty one
+             * is a copy of it, differing only in its address. */
+            struct Type *present;
+            struct Type *empty;
         } opt_type;
 
         struct {
             struct Type *type;
         } list_type;
+
+        struct {
+            /* int or string */
+            struct Type *key;
+            struct Type *value;
+        } map_type;
+
+        struct {
+            Symbol name;
+            /* In the order of declaration, which is also the order in which
+             * the fields are laid out */
+            Vector fields; /* Vector<StructField> */
+        } struct_type;
     };
+
+    /* Interned list<T> and option<T> of this type, so they can be looked up
+     * without formatting their names */
+    struct Type *list_of;
+    struct Type *opt_of;
 } Type;
 
 const char *type_name(const Type *type);
@@ -67,4 +98,10 @@ void type_system_init(TypeSystem *self);
 void type_system_deinit(TypeSystem *self);
 char *type_system_name(TypeSystem *self, const Type *type);
 Type *type_system_register(TypeSystem *self, const Type *type);
+Type *type_system_list(TypeSystem *self, Type *type);
+Type *type_system_option(TypeSystem *self, Type *type);
+Type *type_system_map(TypeSystem *self, Type *key, Type *value);
+/* A new struct without fields, which are added by the caller. Returns NULL if
+ * the name is already taken. */
+Type *type_system_struct(TypeSystem *self, Symbol name);
 Type *type_system_get(TypeSystem *self, const char *name);
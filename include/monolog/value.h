@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "hashmap.h"
 #include "strbuf.h"
 #include "type.h"
 #include "vector.h"
@@ -14,25 +15,117 @@
 #include <stdint.h>
 
 typedef int64_t Int;
-typedef struct Scope Scope;
 
+/*
+ * Two words: the type and the payload. Objects are owned through reference
+ * counts, so a value doesn't need to know where it was created.
+ */
 typedef struct Value {
     Type *type;
-    Scope *scope;
 
     union {
         Int i;
-        /* Pointer to a string, allocated inside scope */
+        /* Pointer to a reference counted string */
         StrBuf *s;
 
         struct {
-            /* Pointer to a Vector<Value>, allocated inside scope */
-            Vector *values; /* Vector<Value> */
+            /* Pointer to a reference counted Vector<Value>, or Vector<Int>
+             * if the list is unboxed */
+            Vector *values;
         } list;
 
         struct {
-            /* Pointer to a value, allocated inside scope */
+            /* Pointer to a reference counted value, if the option is
+             * boxed */
             struct Value *val;
         } opt;
+
+        /* Pointer to a reference counted map */
+        struct ValueMap *map;
+
+        /* Pointer to the reference counted fields of a struct, in the order
+         * of declaration */
+        struct Value *fields;
     };
 } Value;
+
+/* The value is stored as an option of the value type of the map, which is
+ * what a lookup results in */
+typedef struct MapEntry {
+    Value key;
+    Value val;
+    /* Position in ValueMap.entries */
+    size_t idx;
+} MapEntry;
+
+/* Initial capacity of the index of a map */
+#define VALUE_MAP_MIN_CAP HASHMAP_GROUP_WIDTH
+
+typedef struct ValueMap {
+    Type *type;
+    /* Keyed by the characters of string keys and by the bytes of int keys.
+     * It's allocated by the first insertion. */
+    HashMap index; /* HashMap<MapEntry *> */
+    /* In the order of insertion, until an entry is removed */
+    Vector entries; /* Vector<MapEntry *> */
+} ValueMap;
+
+/*
+ * A present option keeps the payload of its inner value inline, and the type
+ * of an empty option is Type.opt_type.empty. Options of options are boxed
+ * instead, since the inner option needs a type of its own.
+ */
+bool value_opt_is_boxed(const Type *type);
+bool value_opt_is_present(const Value *val);
+/* The inner value of a present option */
+Value value_opt_get(const Value *val);
+
+/*
+ * Strings, lists, maps, structs and option boxes are reference counted. A
+ * reference is held by every variable, list, option and temporary which has
+ * the object. Shared objects are copied only when one of the values is about
+ * to be modified. String constants are always shared.
+ *
+ * New objects come with one reference, which belongs to the caller.
+ */
+Value *value_new_box(Type *type);
+StrBuf *value_new_string(void);
+Vector *value_new_list(const Type *type);
+ValueMap *value_new_map(Type *type);
+/* The fields are zeroed, so they have to be initialized by the caller */
+struct Value *value_new_struct(const Type *type);
+
+/*
+ * Slices are views: they share the buffer of the sliced string or list and
+ * keep it alive by a reference. A view is always treated as shared, so it's
+ * copied before it's modified.
+ */
+StrBuf *value_new_string_slice(StrBuf *str, size_t start, size_t len);
+Vector *value_new_list_slice(Vector *list, size_t start, size_t len);
+
+void value_retain(const Value *val);
+void value_release(const Value *val);
+bool value_is_shared(const Value *val);
+void value_pin(const Value *val);
+void value_unpin(const Value *val);
+bool value_is_pinned(const Value *val);
+
+void value_release_string(StrBuf *str);
+void value_release_list(Vector *list, const Type *type);
+void value_release_map(ValueMap *map);
+void value_release_struct(struct Value *fields, const Type *type);
+
+/* Elements of [int] lists are stored as Int rather than Value */
+bool value_list_is_unboxed(const Type *type);
+/* Elements of lists of structs are stored inline: each one is the fields of
+ * the struct, one after another */
+bool value_list_is_inline(const Type *type);
+size_t value_struct_len(const Type *type);
+void value_release_box(Value *box);
+
+/* The entry of the key, or NULL */
+MapEntry *value_map_find(const ValueMap *map, const Value *key);
+/* The map takes over the reference of the key. The value of the new entry is
+ * left for the caller to set. */
+MapEntry *value_map_add(ValueMap *map, const Value *key);
+void value_map_remove(ValueMap *map, MapEntry *entry);
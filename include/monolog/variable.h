@@ -7,17 +7,35 @@
 
 #pragma once
 
+#include "symbol.h"
 #include "type.h"
 #include "value.h"
 
 #include <stdbool.h>
 
+/* Scope depth of global variables. Depths of local variables are counted from
+ * the scope of the function (or from the first block at the top level). */
+#define VAR_GLOBAL_DEPTH -1
+
 typedef struct Scope Scope;
 
 typedef struct Variable {
     Type *type;
-    char *name;
+    Symbol name;
     Value val;
     Scope *scope;
+    /* Index of the variable in its scope's slots */
+    int slot;
     bool is_param;
+    /* The value is an alias of an argument passed by reference, so the
+     * variable doesn't hold a reference to it */
+    bool is_borrowed;
+
+    /* Options are stored inline, so an option parameter passed by reference
+     * refers to the option of the argument instead of val: the value of
+     * another variable, or the element alias_idx of alias_list. val keeps
+     * the passed value in case the element is removed. */
+    Value *alias;
+    Vector *alias_list;
+    size_t alias_idx;
 } Variable;
@@ -25,6 +25,8 @@ void *vec_push(Vector *self, const void *data);
 void *vec_emplace(Vector *self);
 void vec_pop(Vector *self);
 void vec_clear(Vector *self);
+/* Make room for at least cap elements. The new elements are zeroed. */
+bool vec_reserve(Vector *self, size_t cap);
 
 /* NOTE: using on empty vector is an undefined behavior */
 #define VEC_LAST(_self, _type) (((_type *)(_self)->data)[(_self)->len - 1])
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/arena.h>
+#include <monolog/utils.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaChunk {
+    ArenaChunk *next;
+};
+
+/* Cells start after the header at an aligned offset */
+#define CHUNK_HEADER_SIZE                                                      \
+    ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+static size_t size_class(size_t size) {
+    assert(size > 0 && size <= ARENA_MAX_SIZE);
+
+    return (size - 1) / ARENA_ALIGN;
+}
+
+static void new_chunk(Arena *self) {
+    ArenaChunk *chunk = mem_alloc(ARENA_CHUNK_SIZE);
+    chunk->next = self->chunks;
+    self->chunks = chunk;
+
+    /* The rest of the previous chunk is smaller than a cell, so it's lost */
+    self->ptr = (char *) chunk + CHUNK_HEADER_SIZE;
+    self->end = (char *) chunk + ARENA_CHUNK_SIZE;
+
+    ++self->stats.chunks;
+}
+
+void arena_init(Arena *self) {
+    memset(self, 0, sizeof(*self));
+}
+
+void arena_deinit(Arena *self) {
+    ArenaChunk *chunk = self->chunks;
+
+    while (chunk) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena_init(self);
+}
+
+void *arena_alloc(Arena *self, size_t size) {
+    size_t cls = size_class(size);
+    size_t cell_size = (cls + 1) * ARENA_ALIGN;
+    void *cell = self->free_lists[cls];
+
+    if (cell) {
+        /* A free cell stores the next one in its first word */
+        self->free_lists[cls] = *(void **) cell;
+        memset(cell, 0, cell_size);
+    } else {
+        if ((size_t) (self->end - self->ptr) < cell_size) {
+            new_chunk(self);
+        }
+
+        /* Chunks are allocated zeroed */
+        cell = self->ptr;
+        self->ptr += cell_size;
+    }
+
+    ++self->stats.allocs;
+    self->stats.bytes += cell_size;
+
+    return cell;
+}
+
+void arena_free(Arena *self, void *ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+
+    size_t cls = size_class(size);
+
+    *(void **) ptr = self->free_lists[cls];
+    self->free_lists[cls] = ptr;
+
+    ++self->stats.frees;
+}
@@ -33,14 +33,11 @@ void astnode_destroy(AstNode *self) {
     switch (self->kind) {
     case AST_NODE_ERROR:
     case AST_NODE_INTEGER:
+    case AST_NODE_IDENT:
         break;
     case AST_NODE_STRING:
         str_deinit(&self->literal.str);
 
-        break;
-    case AST_NODE_IDENT:
-        str_deinit(&self->ident.str);
-
         break;
     case AST_NODE_UNARY:
         astnode_destroy(self->unary.right);
@@ -85,6 +82,25 @@ void astnode_destroy(AstNode *self) {
         astnode_destroy(self->subscript.left);
         self->subscript.left = NULL;
 
+        break;
+    case AST_NODE_SLICE:
+        astnode_destroy(self->slice.left);
+        self->slice.left = NULL;
+
+        astnode_destroy(self->slice.start);
+        self->slice.start = NULL;
+
+        astnode_destroy(self->slice.end);
+        self->slice.end = NULL;
+
+        break;
+    case AST_NODE_FIELD:
+        astnode_destroy(self->field.left);
+        self->field.left = NULL;
+
+        astnode_destroy(self->field.name);
+        self->field.name = NULL;
+
         break;
     case AST_NODE_IF:
         astnode_destroy(self->kw_if.cond);
@@ -118,6 +134,17 @@ void astnode_destroy(AstNode *self) {
         astnode_destroy(self->kw_for.body);
         self->kw_for.body = NULL;
 
+        break;
+    case AST_NODE_FOR_EACH:
+        astnode_destroy(self->kw_for_each.var);
+        self->kw_for_each.var = NULL;
+
+        astnode_destroy(self->kw_for_each.map);
+        self->kw_for_each.map = NULL;
+
+        astnode_destroy(self->kw_for_each.body);
+        self->kw_for_each.body = NULL;
+
         break;
     case AST_NODE_BLOCK: {
         AstNode **nodes = self->block.nodes.data;
@@ -133,6 +160,7 @@ void astnode_destroy(AstNode *self) {
     case AST_NODE_INT_TYPE:
     case AST_NODE_STRING_TYPE:
     case AST_NODE_VOID_TYPE:
+    case AST_NODE_STRUCT_TYPE:
         break;
     case AST_NODE_OPTION_TYPE:
         astnode_destroy(self->opt_type.type);
@@ -146,6 +174,14 @@ void astnode_destroy(AstNode *self) {
         astnode_destroy(self->list_type.size);
         self->list_type.size = NULL;
 
+        break;
+    case AST_NODE_MAP_TYPE:
+        astnode_destroy(self->map_type.key);
+        self->map_type.key = NULL;
+
+        astnode_destroy(self->map_type.value);
+        self->map_type.value = NULL;
+
         break;
     case AST_NODE_VAR_DECL:
         astnode_destroy(self->var_decl.type);
@@ -185,6 +221,20 @@ void astnode_destroy(AstNode *self) {
         self->fn_decl.body = NULL;
 
         break;
+    case AST_NODE_STRUCT_DECL: {
+        astnode_destroy(self->struct_decl.name);
+        self->struct_decl.name = NULL;
+
+        AstNode **fields = self->struct_decl.fields.data;
+
+        for (size_t i = 0; i < self->struct_decl.fields.len; ++i) {
+            astnode_destroy(fields[i]);
+        }
+
+        vec_deinit(&self->struct_decl.fields);
+
+        break;
+    }
     case AST_NODE_RETURN:
         astnode_destroy(self->kw_return.expr);
         self->kw_return.expr = NULL;
@@ -199,6 +249,95 @@ void astnode_destroy(AstNode *self) {
     free(self);
 }
 
+AstNode *astnode_clone(const AstNode *self) {
+    if (!self) {
+        return NULL;
+    }
+
+    AstNode *node = astnode_new(self->kind, &self->tok);
+    node->type = self->type;
+
+    switch (self->kind) {
+    case AST_NODE_ERROR:
+    case AST_NODE_NIL:
+        break;
+    case AST_NODE_INTEGER:
+        node->literal.i = self->literal.i;
+
+        break;
+    case AST_NODE_STRING:
+        str_dup_n(
+            &node->literal.str, str_data(&self->literal.str),
+            str_len(&self->literal.str)
+        );
+
+        break;
+    case AST_NODE_IDENT:
+        node->ident.name = self->ident.name;
+        node->ident.depth = self->ident.depth;
+        node->ident.slot = self->ident.slot;
+
+        break;
+    case AST_NODE_UNARY:
+        node->unary.op = self->unary.op;
+        node->unary.right = astnode_clone(self->unary.right);
+
+        break;
+    case AST_NODE_BINARY:
+        node->binary.op = self->binary.op;
+        node->binary.left = astnode_clone(self->binary.left);
+        node->binary.right = astnode_clone(self->binary.right);
+
+        break;
+    case AST_NODE_SUFFIX:
+        node->suffix.op = self->suffix.op;
+        node->suffix.left = astnode_clone(self->suffix.left);
+
+        break;
+    case AST_NODE_GROUPING:
+        node->grouping.expr = astnode_clone(self->grouping.expr);
+
+        break;
+    case AST_NODE_FN_CALL: {
+        node->fn_call.name = astnode_clone(self->fn_call.name);
+        vec_init(&node->fn_call.values, sizeof(AstNode *));
+
+        AstNode **values = self->fn_call.values.data;
+
+        for (size_t i = 0; i < self->fn_call.values.len; ++i) {
+            AstNode *value = astnode_clone(values[i]);
+            vec_push(&node->fn_call.values, &value);
+        }
+
+        break;
+    }
+    case AST_NODE_SUBSCRIPT:
+        node->subscript.expr = astnode_clone(self->subscript.expr);
+        node->subscript.left = astnode_clone(self->subscript.left);
+
+        break;
+    case AST_NODE_SLICE:
+        node->slice.left = astnode_clone(self->slice.left);
+        node->slice.start = astnode_clone(self->slice.start);
+        node->slice.end = astnode_clone(self->slice.end);
+
+        break;
+    case AST_NODE_FIELD:
+        node->field.left = astnode_clone(self->field.left);
+        node->field.name = astnode_clone(self->field.name);
+        node->field.idx = self->field.idx;
+
+        break;
+    default:
+        /* statements aren't cloned */
+        astnode_destroy(node);
+
+        return NULL;
+    }
+
+    return node;
+}
+
 static void print_node(const AstNode *node, FILE *out, int indent) {
     for (int i = 0; i < indent; ++i) {
         fprintf(out, "  ");
@@ -220,11 +359,11 @@ static void print_node(const AstNode *node, FILE *out, int indent) {
 
         break;
     case AST_NODE_STRING:
-        fprintf(out, "literal \"%s\"\n", node->literal.str.data);
+        fprintf(out, "literal \"%s\"\n", str_data(&node->literal.str));
 
         break;
     case AST_NODE_IDENT:
-        fprintf(out, "identifier %s\n", node->ident.str.data);
+        fprintf(out, "identifier %s\n", node->ident.name);
 
         break;
     case AST_NODE_UNARY:
@@ -265,6 +404,19 @@ static void print_node(const AstNode *node, FILE *out, int indent) {
         print_node(node->subscript.expr, out, indent + 1);
         print_node(node->subscript.left, out, indent + 1);
 
+        break;
+    case AST_NODE_SLICE:
+        fprintf(out, "slice:\n");
+        print_node(node->slice.left, out, indent + 1);
+        print_node(node->slice.start, out, indent + 1);
+        print_node(node->slice.end, out, indent + 1);
+
+        break;
+    case AST_NODE_FIELD:
+        fprintf(out, "field:\n");
+        print_node(node->field.left, out, indent + 1);
+        print_node(node->field.name, out, indent + 1);
+
         break;
     case AST_NODE_IF:
         if (node->kw_if.else_body) {
@@ -306,6 +458,13 @@ static void print_node(const AstNode *node, FILE *out, int indent) {
         print_node(node->kw_for.iter, out, indent + 1);
         print_node(node->kw_for.body, out, indent + 1);
 
+        break;
+    case AST_NODE_FOR_EACH:
+        fprintf(out, "for-each:\n");
+        print_node(node->kw_for_each.var, out, indent + 1);
+        print_node(node->kw_for_each.map, out, indent + 1);
+        print_node(node->kw_for_each.body, out, indent + 1);
+
         break;
     case AST_NODE_INT_TYPE:
         fprintf(out, "int-type\n");
@@ -329,6 +488,16 @@ static void print_node(const AstNode *node, FILE *out, int indent) {
         print_node(node->list_type.type, out, indent + 1);
         print_node(node->list_type.size, out, indent + 1);
 
+        break;
+    case AST_NODE_MAP_TYPE:
+        fprintf(out, "map-type:\n");
+        print_node(node->map_type.key, out, indent + 1);
+        print_node(node->map_type.value, out, indent + 1);
+
+        break;
+    case AST_NODE_STRUCT_TYPE:
+        fprintf(out, "struct-type %s\n", node->struct_type.name);
+
         break;
     case AST_NODE_VAR_DECL:
         fprintf(out, "var-decl:\n");
@@ -358,6 +527,18 @@ static void print_node(const AstNode *node, FILE *out, int indent) {
 
         break;
     }
+    case AST_NODE_STRUCT_DECL: {
+        fprintf(out, "struct-decl:\n");
+        print_node(node->struct_decl.name, out, indent + 1);
+
+        AstNode **nodes = node->struct_decl.fields.data;
+
+        for (size_t i = 0; i < node->struct_decl.fields.len; ++i) {
+            print_node(nodes[i], out, indent + 1);
+        }
+
+        break;
+    }
     case AST_NODE_RETURN:
         fprintf(out, "return:\n");
         print_node(node->kw_return.expr, out, indent + 1);
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/bytecode.h>
+#include <monolog/function.h>
+#include <monolog/lexer.h>
+#include <monolog/rc.h>
+#include <monolog/strbuf.h>
+#include <monolog/utils.h>
+#include <monolog/variable.h>
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *g_op_names[] = {
+    "INT",         "STRING",        "NIL",        "GET_VAR",
+    "POP",         "UNARY",         "BINARY",     "SUFFIX",
+    "ASSIGN",      "APPEND",        "SUBSCRIPT",  "SLICE",
+    "FIELD",       "FIELD_MUT",
+    "CALL",        "TAIL_CALL",     "JUMP",
+    "JUMP_IF_FALSE", "JUMP_IF_TRUE", "AND",       "OR",
+    "BOOL",        "ENTER_SCOPE",   "LEAVE_SCOPE", "LIST_SIZE",
+    "MAP_KEYS",    "VAR_DECL",      "FN_DECL",    "RETURN",
+    "INVALID",     "END",
+};
+
+void const_pool_init(ConstPool *self) {
+    vec_init(&self->strings, sizeof(StrBuf *));
+}
+
+void const_pool_deinit(ConstPool *self) {
+    StrBuf **strings = self->strings.data;
+
+    for (size_t i = 0; i < self->strings.len; ++i) {
+        str_deinit(strings[i]);
+        rc_free(strings[i]);
+    }
+
+    vec_deinit(&self->strings);
+}
+
+StrBuf *const_pool_add_string(ConstPool *self, const char *str, size_t len) {
+    /* Constants are shared by every value they're assigned to */
+    StrBuf *buf = rc_alloc(sizeof(*buf));
+    rc_make_static(buf);
+
+    str_dup_n(buf, str, len);
+    vec_push(&self->strings, &buf);
+
+    return buf;
+}
+
+void chunk_init(Chunk *self) {
+    vec_init(&self->code, sizeof(Instr));
+    vec_init(&self->src_infos, sizeof(SourceInfo));
+    vec_init(&self->ints, sizeof(int64_t));
+    vec_init(&self->strings, sizeof(StrBuf *));
+    vec_init(&self->names, sizeof(Symbol));
+    vec_init(&self->var_refs, sizeof(VarRef));
+    vec_init(&self->call_sites, sizeof(CallSite));
+    vec_init(&self->var_decls, sizeof(VarDeclInfo));
+    vec_init(&self->fns, sizeof(Function *));
+}
+
+void chunk_deinit(Chunk *self) {
+    Function **fns = self->fns.data;
+
+    for (size_t i = 0; i < self->fns.len; ++i) {
+        /* not declared at runtime, so still owned by the chunk */
+        if (fns[i]) {
+            fn_deinit(fns[i]);
+            free(fns[i]);
+        }
+    }
+
+    vec_deinit(&self->code);
+    vec_deinit(&self->src_infos);
+    vec_deinit(&self->ints);
+    vec_deinit(&self->strings);
+    vec_deinit(&self->names);
+    vec_deinit(&self->var_refs);
+    vec_deinit(&self->call_sites);
+    vec_deinit(&self->var_decls);
+    vec_deinit(&self->fns);
+}
+
+size_t chunk_emit(Chunk *self, OpCode op, int32_t arg, SourceInfo src_info) {
+    Instr instr = {op, arg};
+
+    vec_push(&self->code, &instr);
+    vec_push(&self->src_infos, &src_info);
+
+    return self->code.len - 1;
+}
+
+int32_t chunk_add_int(Chunk *self, int64_t i) {
+    vec_push(&self->ints, &i);
+
+    return (int32_t) self->ints.len - 1;
+}
+
+int32_t chunk_add_string(Chunk *self, StrBuf *str) {
+    vec_push(&self->strings, &str);
+
+    return (int32_t) self->strings.len - 1;
+}
+
+int32_t chunk_add_name(Chunk *self, Symbol name) {
+    const Symbol *names = self->names.data;
+
+    for (size_t i = 0; i < self->names.len; ++i) {
+        if (names[i] == name) {
+            return (int32_t) i;
+        }
+    }
+
+    vec_push(&self->names, &name);
+
+    return (int32_t) self->names.len - 1;
+}
+
+int32_t chunk_add_var_ref(Chunk *self, int depth, int slot, Symbol name) {
+    VarRef ref = {depth, slot, chunk_add_name(self, name)};
+    const VarRef *refs = self->var_refs.data;
+
+    for (size_t i = 0; i < self->var_refs.len; ++i) {
+        if (refs[i].depth == ref.depth && refs[i].slot == ref.slot &&
+            refs[i].name == ref.name) {
+            return (int32_t) i;
+        }
+    }
+
+    vec_push(&self->var_refs, &ref);
+
+    return (int32_t) self->var_refs.len - 1;
+}
+
+int32_t chunk_add_call_site(Chunk *self, Symbol name) {
+    CallSite site = {chunk_add_name(self, name), 0, NULL};
+    vec_push(&self->call_sites, &site);
+
+    return (int32_t) self->call_sites.len - 1;
+}
+
+static void dump_instr(const Chunk *self, const Instr *instr, FILE *out) {
+    const Symbol *names = self->names.data;
+
+    fprintf(out, "%-14s", g_op_names[instr->op]);
+
+    switch (instr->op) {
+    case OP_INT:
+        fprintf(out, "%" PRId64, ((const int64_t *) self->ints.data)[instr->arg]);
+
+        break;
+    case OP_STRING:
+        fprintf(
+            out, "\"%s\"",
+            str_data(((StrBuf *const *) self->strings.data)[instr->arg])
+        );
+
+        break;
+    case OP_GET_VAR: {
+        const VarRef *ref = &((const VarRef *) self->var_refs.data)[instr->arg];
+
+        if (ref->depth == VAR_GLOBAL_DEPTH) {
+            fprintf(out, "%s (global %d)", names[ref->name], ref->slot);
+        } else {
+            fprintf(
+                out, "%s (%d:%d)", names[ref->name], ref->depth, ref->slot
+            );
+        }
+
+        break;
+    }
+    case OP_CALL:
+    case OP_TAIL_CALL: {
+        const CallSite *site =
+            &((const CallSite *) self->call_sites.data)[instr->arg];
+        fprintf(out, "%s", names[site->name]);
+
+        break;
+    }
+    case OP_UNARY:
+    case OP_BINARY:
+    case OP_SUFFIX:
+        fprintf(out, "%s", token_kind_to_str((TokenKind) instr->arg));
+
+        break;
+    case OP_VAR_DECL: {
+        const VarDeclInfo *decl =
+            &((const VarDeclInfo *) self->var_decls.data)[instr->arg];
+
+        fprintf(
+            out, "%s %s (%d)", decl->type->name, names[decl->name], decl->slot
+        );
+
+        break;
+    }
+    case OP_FN_DECL: {
+        const Function *fn = ((Function *const *) self->fns.data)[instr->arg];
+        fprintf(out, "%s", fn ? fn->name : "(declared)");
+
+        break;
+    }
+    case OP_SUBSCRIPT:
+    case OP_SLICE:
+    case OP_FIELD:
+    case OP_FIELD_MUT:
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_TRUE:
+    case OP_AND:
+    case OP_OR:
+    case OP_LEAVE_SCOPE:
+    case OP_RETURN:
+        fprintf(out, "%" PRId32, instr->arg);
+
+        break;
+    default:
+        break;
+    }
+
+    fputc('\n', out);
+}
+
+void chunk_dump(const Chunk *self, FILE *out) {
+    const Instr *code = self->code.data;
+    const SourceInfo *src_infos = self->src_infos.data;
+
+    for (size_t i = 0; i < self->code.len; ++i) {
+        fprintf(
+            out, "%4zu %4d:%-4d ", i, src_infos[i].line, src_infos[i].col
+        );
+        dump_instr(self, &code[i], out);
+    }
+
+    Function **fns = self->fns.data;
+
+    for (size_t i = 0; i < self->fns.len; ++i) {
+        if (fns[i] && fns[i]->chunk) {
+            fprintf(out, "\nfunction %s:\n", fns[i]->name);
+            chunk_dump(fns[i]->chunk, out);
+        }
+    }
+}
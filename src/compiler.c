@@ -0,0 +1,805 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/compiler.h>
+#include <monolog/function.h>
+#include <monolog/utils.h>
+
+#include <stdlib.h>
+
+typedef struct LoopInfo {
+    /* Scope depth outside of the loop body */
+    int scope_depth;
+    /* Jumps to patch once the loop end and continue target are known */
+    Vector breaks; /* Vector<size_t> */
+    Vector continues; /* Vector<size_t> */
+} LoopInfo;
+
+static size_t
+emit(Compiler *self, OpCode op, int32_t arg, SourceInfo src_info) {
+    return chunk_emit(self->chunk, op, arg, src_info);
+}
+
+static void patch_jump(Compiler *self, size_t jump, size_t target) {
+    Instr *code = self->chunk->code.data;
+    code[jump].arg = (int32_t) target;
+}
+
+static void patch_jumps(Compiler *self, const Vector *jumps, size_t target) {
+    const size_t *idxs = jumps->data;
+
+    for (size_t i = 0; i < jumps->len; ++i) {
+        patch_jump(self, idxs[i], target);
+    }
+}
+
+/* Types are resolved and stored in type nodes by semantic checker */
+static Type *process_type(Compiler *self, const AstNode *node) {
+    return node->type ? node->type : self->types->error_type;
+}
+
+static void
+compile_expr(Compiler *self, const AstNode *node, bool assigning);
+
+static void compile_fn_call(Compiler *self, const AstNode *node, OpCode op) {
+    const AstNode **args = node->fn_call.values.data;
+
+    /* Arguments are evaluated in the caller's scope before the call. They're
+     * compiled as lvalues, since elements are passed by reference. */
+    for (size_t i = 0; i < node->fn_call.values.len; ++i) {
+        compile_expr(self, args[i], true);
+    }
+
+    int32_t site = chunk_add_call_site(
+        self->chunk, node->fn_call.name->ident.name
+    );
+    emit(self, op, site, node->tok.src_info);
+}
+
+/* The expression may assign a variable. Calls are assumed to do so. */
+static bool has_side_effects(const AstNode *node) {
+    switch (node->kind) {
+    case AST_NODE_INTEGER:
+    case AST_NODE_STRING:
+    case AST_NODE_IDENT:
+    case AST_NODE_NIL:
+        return false;
+    case AST_NODE_GROUPING:
+        return has_side_effects(node->grouping.expr);
+    case AST_NODE_UNARY:
+        return node->unary.op.kind == TOKEN_INC ||
+               node->unary.op.kind == TOKEN_DEC ||
+               has_side_effects(node->unary.right);
+    case AST_NODE_BINARY:
+        switch (node->binary.op.kind) {
+        case TOKEN_ASSIGN:
+        case TOKEN_ADD_ASSIGN:
+        case TOKEN_SUB_ASSIGN:
+        case TOKEN_HASHTAG_ASSIGN:
+            return true;
+        default:
+            return has_side_effects(node->binary.left) ||
+                   has_side_effects(node->binary.right);
+        }
+    case AST_NODE_SUBSCRIPT:
+        return has_side_effects(node->subscript.left) ||
+               has_side_effects(node->subscript.expr);
+    default:
+        return true;
+    }
+}
+
+/*
+ * Finds s + a in s = s + a + b + ..., where s is a string variable. It's
+ * compiled as s = s + (a + b + ...), so b and the following operands mustn't
+ * modify s, which is then read after them.
+ */
+static const AstNode *find_append(const AstNode *node) {
+    const AstNode *var = node->binary.left;
+    const AstNode *sum = node->binary.right;
+
+    if (var->kind != AST_NODE_IDENT) {
+        return NULL;
+    }
+
+    while (sum->kind == AST_NODE_BINARY && sum->binary.op.kind == TOKEN_PLUS &&
+           sum->type && sum->type->id == TYPE_STRING) {
+        const AstNode *left = sum->binary.left;
+
+        if (left->kind == AST_NODE_IDENT &&
+            left->ident.name == var->ident.name &&
+            left->ident.depth == var->ident.depth &&
+            left->ident.slot == var->ident.slot) {
+            return sum;
+        }
+
+        if (has_side_effects(sum->binary.right)) {
+            return NULL;
+        }
+
+        sum = left;
+    }
+
+    return NULL;
+}
+
+/* The operands of the sum after s, up to the innermost s + a */
+static void
+compile_appended(Compiler *self, const AstNode *sum, const AstNode *inner) {
+    if (sum != inner) {
+        compile_appended(self, sum->binary.left, inner);
+    }
+
+    compile_expr(self, sum->binary.right, false);
+
+    if (sum != inner) {
+        emit(
+            self, OP_BINARY, (int32_t) TOKEN_PLUS, sum->binary.op.src_info
+        );
+    }
+}
+
+static void
+compile_expr(Compiler *self, const AstNode *node, bool assigning) {
+    SourceInfo src_info = node->tok.src_info;
+
+    switch (node->kind) {
+    case AST_NODE_INTEGER:
+        emit(
+            self, OP_INT, chunk_add_int(self->chunk, node->literal.i), src_info
+        );
+
+        break;
+    case AST_NODE_STRING: {
+        StrBuf *lit = const_pool_add_string(
+            self->consts, str_data(&node->literal.str),
+            str_len(&node->literal.str)
+        );
+        int32_t str = chunk_add_string(self->chunk, lit);
+        emit(self, OP_STRING, str, src_info);
+
+        break;
+    }
+    case AST_NODE_IDENT: {
+        int32_t ref = chunk_add_var_ref(
+            self->chunk, node->ident.depth, node->ident.slot,
+            node->ident.name
+        );
+        emit(self, OP_GET_VAR, ref, src_info);
+
+        break;
+    }
+    case AST_NODE_NIL:
+        emit(self, OP_NIL, 0, src_info);
+
+        break;
+    case AST_NODE_UNARY:
+        /* the value of a dereferenced option can be assigned, and the
+         * operand of ++ and -- is incremented in place */
+        compile_expr(
+            self, node->unary.right,
+            (assigning && node->unary.op.kind == TOKEN_MUL) ||
+                node->unary.op.kind == TOKEN_INC ||
+                node->unary.op.kind == TOKEN_DEC
+        );
+        emit(
+            self, OP_UNARY, (int32_t) node->unary.op.kind,
+            node->unary.op.src_info
+        );
+
+        break;
+    case AST_NODE_BINARY: {
+        Token op = node->binary.op;
+        bool assign = op.kind == TOKEN_ASSIGN;
+
+        if (op.kind == TOKEN_AND || op.kind == TOKEN_OR) {
+            /* The right operand is evaluated only if the left one doesn't
+             * decide the result */
+            compile_expr(self, node->binary.left, false);
+            size_t jump_end = emit(
+                self, op.kind == TOKEN_AND ? OP_AND : OP_OR, 0, op.src_info
+            );
+
+            compile_expr(self, node->binary.right, false);
+            emit(self, OP_BOOL, 0, op.src_info);
+            patch_jump(self, jump_end, self->chunk->code.len);
+
+            break;
+        }
+
+        const AstNode *append = assign ? find_append(node) : NULL;
+
+        if (append) {
+            compile_expr(self, node->binary.left, true);
+            compile_appended(self, node->binary.right, append);
+            emit(self, OP_APPEND, 0, append->binary.op.src_info);
+
+            break;
+        }
+
+        /* +=, -= and #= modify the list in place, so the structs and lists
+         * which contain it are made unique as well */
+        bool modifying = assign || op.kind == TOKEN_ADD_ASSIGN ||
+                         op.kind == TOKEN_SUB_ASSIGN ||
+                         op.kind == TOKEN_HASHTAG_ASSIGN;
+
+        compile_expr(self, node->binary.left, modifying);
+        compile_expr(self, node->binary.right, false);
+
+        if (assign) {
+            emit(self, OP_ASSIGN, 0, op.src_info);
+        } else {
+            emit(self, OP_BINARY, (int32_t) op.kind, op.src_info);
+        }
+
+        break;
+    }
+    case AST_NODE_SUFFIX:
+        /* the operand is incremented in place */
+        compile_expr(self, node->suffix.left, true);
+        emit(
+            self, OP_SUFFIX, (int32_t) node->suffix.op.kind,
+            node->suffix.op.src_info
+        );
+
+        break;
+    case AST_NODE_SUBSCRIPT:
+        /* the containers of an assigned element are modified too */
+        compile_expr(self, node->subscript.left, assigning);
+        compile_expr(self, node->subscript.expr, false);
+        emit(self, OP_SUBSCRIPT, assigning, src_info);
+
+        break;
+    case AST_NODE_SLICE:
+        compile_expr(self, node->slice.left, false);
+
+        if (node->slice.start) {
+            compile_expr(self, node->slice.start, false);
+        } else {
+            emit(self, OP_INT, chunk_add_int(self->chunk, 0), src_info);
+        }
+
+        /* an omitted end is the length of the container */
+        if (node->slice.end) {
+            compile_expr(self, node->slice.end, false);
+        }
+
+        emit(self, OP_SLICE, !node->slice.end, src_info);
+
+        break;
+    case AST_NODE_FIELD:
+        /* the struct of an assigned field is modified too */
+        compile_expr(self, node->field.left, assigning);
+        emit(
+            self, assigning ? OP_FIELD_MUT : OP_FIELD, node->field.idx,
+            src_info
+        );
+
+        break;
+    case AST_NODE_GROUPING:
+        compile_expr(self, node->grouping.expr, assigning);
+
+        break;
+    case AST_NODE_FN_CALL:
+        compile_fn_call(self, node, OP_CALL);
+
+        break;
+    default:
+        emit(self, OP_INVALID, 0, src_info);
+
+        break;
+    }
+}
+
+static void compile_stmt(Compiler *self, const AstNode *node);
+
+/* Emits jumps taken when the condition is equal to jump_if and adds them to
+ * jumps, falling through otherwise. The condition is never materialized as
+ * a value: && and || become chains of jumps. */
+static void compile_cond(
+    Compiler *self, const AstNode *node, bool jump_if, Vector *jumps
+) {
+    switch (node->kind) {
+    case AST_NODE_GROUPING:
+        compile_cond(self, node->grouping.expr, jump_if, jumps);
+
+        return;
+    case AST_NODE_UNARY:
+        if (node->unary.op.kind == TOKEN_EXCL) {
+            compile_cond(self, node->unary.right, !jump_if, jumps);
+
+            return;
+        }
+
+        break;
+    case AST_NODE_BINARY: {
+        TokenKind op = node->binary.op.kind;
+
+        if (op != TOKEN_AND && op != TOKEN_OR) {
+            break;
+        }
+
+        /* a && b jumps on false if either does, a || b jumps on true if
+         * either does */
+        bool short_circuits = op == TOKEN_AND ? !jump_if : jump_if;
+
+        if (short_circuits) {
+            compile_cond(self, node->binary.left, jump_if, jumps);
+            compile_cond(self, node->binary.right, jump_if, jumps);
+        } else {
+            Vector skip;
+            vec_init(&skip, sizeof(size_t));
+
+            compile_cond(self, node->binary.left, !jump_if, &skip);
+            compile_cond(self, node->binary.right, jump_if, jumps);
+            patch_jumps(self, &skip, self->chunk->code.len);
+
+            vec_deinit(&skip);
+        }
+
+        return;
+    }
+    case AST_NODE_INTEGER:
+        /* A constant condition either always jumps or never does */
+        if ((node->literal.i != 0) == jump_if) {
+            size_t jump = emit(self, OP_JUMP, 0, node->tok.src_info);
+            vec_push(jumps, &jump);
+        }
+
+        return;
+    default:
+        break;
+    }
+
+    compile_expr(self, node, false);
+
+    size_t jump = emit(
+        self, jump_if ? OP_JUMP_IF_TRUE : OP_JUMP_IF_FALSE, 0,
+        node->tok.src_info
+    );
+    vec_push(jumps, &jump);
+}
+
+static void compile_block(Compiler *self, const AstNode *node) {
+    if (node->block.nodes.len == 0) {
+        return;
+    }
+
+    const AstNode **nodes = node->block.nodes.data;
+
+    emit(self, OP_ENTER_SCOPE, 0, node->tok.src_info);
+    ++self->scope_depth;
+
+    for (size_t i = 0; i < node->block.nodes.len; ++i) {
+        compile_stmt(self, nodes[i]);
+    }
+
+    --self->scope_depth;
+    emit(self, OP_LEAVE_SCOPE, 1, node->tok.src_info);
+}
+
+static void compile_var_decl(Compiler *self, const AstNode *node) {
+    VarDeclInfo decl = {0};
+    decl.type = process_type(self, node->var_decl.type);
+    decl.name =
+        chunk_add_name(self->chunk, node->var_decl.name->ident.name);
+    decl.slot = node->var_decl.name->ident.slot;
+
+    const AstNode *size_node = node->var_decl.type->list_type.size;
+
+    if (decl.type->id == TYPE_LIST && size_node) {
+        compile_expr(self, size_node, false);
+        emit(self, OP_LIST_SIZE, 0, size_node->tok.src_info);
+
+        decl.has_size = true;
+    }
+
+    if (node->var_decl.rvalue) {
+        compile_expr(self, node->var_decl.rvalue, false);
+
+        decl.has_init = true;
+    }
+
+    vec_push(&self->chunk->var_decls, &decl);
+    emit(
+        self, OP_VAR_DECL, (int32_t) self->chunk->var_decls.len - 1,
+        node->tok.src_info
+    );
+}
+
+static void
+create_param_list(Compiler *self, Function *fn, const AstNode *node) {
+    const AstNode **params_nodes = node->fn_decl.params.data;
+
+    for (size_t i = 0; i < node->fn_decl.params.len; ++i) {
+        const AstNode *param_node = params_nodes[i];
+        Type *param_type = process_type(self, param_node->param_decl.type);
+
+        FnParam *param = vec_emplace(&fn->params);
+
+        param->type = param_type;
+        param->name = param_node->param_decl.name->ident.name;
+    }
+}
+
+static void compile_fn_decl(Compiler *self, const AstNode *node) {
+    Function *fn = mem_alloc(sizeof(*fn));
+
+    fn->type = process_type(self, node->fn_decl.type);
+    fn->name = node->fn_decl.name->ident.name;
+    fn->is_builtin = false;
+
+    vec_init(&fn->params, sizeof(FnParam));
+    create_param_list(self, fn, node);
+
+    if (node->fn_decl.body) {
+        fn->chunk = mem_alloc(sizeof(*fn->chunk));
+        chunk_init(fn->chunk);
+
+        Compiler fn_compiler;
+        compiler_init(&fn_compiler, self->types, self->consts);
+        fn_compiler.chunk = fn->chunk;
+        fn_compiler.fn = node;
+
+        compile_stmt(&fn_compiler, node->fn_decl.body);
+        /* Reached only if the body doesn't end with a return */
+        emit(&fn_compiler, OP_RETURN, 0, node->tok.src_info);
+
+        compiler_deinit(&fn_compiler);
+    }
+
+    vec_push(&self->chunk->fns, &fn);
+    emit(
+        self, OP_FN_DECL, (int32_t) self->chunk->fns.len - 1,
+        node->tok.src_info
+    );
+}
+
+static void compile_if(Compiler *self, const AstNode *node) {
+    Vector jumps_else;
+    vec_init(&jumps_else, sizeof(size_t));
+
+    compile_cond(self, node->kw_if.cond, false, &jumps_else);
+
+    if (node->kw_if.body) {
+        compile_stmt(self, node->kw_if.body);
+    }
+
+    if (node->kw_if.else_body) {
+        size_t jump_end = emit(self, OP_JUMP, 0, node->tok.src_info);
+
+        patch_jumps(self, &jumps_else, self->chunk->code.len);
+        compile_stmt(self, node->kw_if.else_body);
+        patch_jump(self, jump_end, self->chunk->code.len);
+    } else {
+        patch_jumps(self, &jumps_else, self->chunk->code.len);
+    }
+
+    vec_deinit(&jumps_else);
+}
+
+static LoopInfo *enter_loop(Compiler *self) {
+    LoopInfo *loop = vec_emplace(&self->loops);
+
+    loop->scope_depth = self->scope_depth;
+    vec_init(&loop->breaks, sizeof(size_t));
+    vec_init(&loop->continues, sizeof(size_t));
+
+    return loop;
+}
+
+static void
+leave_loop(Compiler *self, size_t break_target, size_t continue_target) {
+    LoopInfo *loop = &VEC_LAST(&self->loops, LoopInfo);
+
+    patch_jumps(self, &loop->breaks, break_target);
+    patch_jumps(self, &loop->continues, continue_target);
+
+    vec_deinit(&loop->breaks);
+    vec_deinit(&loop->continues);
+    vec_pop(&self->loops);
+}
+
+static void compile_while(Compiler *self, const AstNode *node) {
+    size_t start = self->chunk->code.len;
+
+    Vector jumps_end;
+    vec_init(&jumps_end, sizeof(size_t));
+
+    compile_cond(self, node->kw_while.cond, false, &jumps_end);
+
+    enter_loop(self);
+
+    if (node->kw_while.body) {
+        compile_stmt(self, node->kw_while.body);
+    }
+
+    emit(self, OP_JUMP, (int32_t) start, node->tok.src_info);
+
+    size_t end = self->chunk->code.len;
+    patch_jumps(self, &jumps_end, end);
+    leave_loop(self, end, start);
+
+    vec_deinit(&jumps_end);
+}
+
+static void compile_for(Compiler *self, const AstNode *node) {
+    emit(self, OP_ENTER_SCOPE, 0, node->tok.src_info);
+    ++self->scope_depth;
+
+    if (node->kw_for.init) {
+        compile_stmt(self, node->kw_for.init);
+    }
+
+    size_t start = self->chunk->code.len;
+
+    Vector jumps_end;
+    vec_init(&jumps_end, sizeof(size_t));
+
+    if (node->kw_for.cond) {
+        compile_cond(self, node->kw_for.cond, false, &jumps_end);
+    }
+
+    enter_loop(self);
+
+    if (node->kw_for.body) {
+        compile_stmt(self, node->kw_for.body);
+    }
+
+    size_t iter = self->chunk->code.len;
+
+    if (node->kw_for.iter) {
+        compile_expr(self, node->kw_for.iter, false);
+        emit(self, OP_POP, 0, node->kw_for.iter->tok.src_info);
+    }
+
+    emit(self, OP_JUMP, (int32_t) start, node->tok.src_info);
+
+    size_t end = self->chunk->code.len;
+    patch_jumps(self, &jumps_end, end);
+    leave_loop(self, end, iter);
+    vec_deinit(&jumps_end);
+
+    --self->scope_depth;
+    emit(self, OP_LEAVE_SCOPE, 1, node->tok.src_info);
+}
+
+/* Declare a variable initialized by the value on top of the stack */
+static void emit_var_decl(
+    Compiler *self, Type *type, Symbol name, int slot, SourceInfo src_info
+) {
+    VarDeclInfo decl = {0};
+    decl.type = type;
+    decl.name = chunk_add_name(self->chunk, name);
+    decl.slot = slot;
+    decl.has_init = true;
+
+    vec_push(&self->chunk->var_decls, &decl);
+    emit(
+        self, OP_VAR_DECL, (int32_t) self->chunk->var_decls.len - 1, src_info
+    );
+}
+
+/*
+ * for (K key : map) body is compiled as
+ *
+ *     {
+ *         [K] keys = <keys of map>;
+ *         int index = 0;
+ *
+ *         while (index < #keys) {
+ *             { K key = keys[index]; body }
+ *             ++index;
+ *         }
+ *     }
+ *
+ * with keys and index hidden from the body.
+ */
+static void compile_for_each(Compiler *self, const AstNode *node) {
+    SourceInfo src_info = node->tok.src_info;
+    const AstNode *var = node->kw_for_each.var;
+    Type *key_type = process_type(self, var->param_decl.type);
+
+    Symbol keys_name = sym_intern_cstr(AST_FOR_EACH_KEYS);
+    Symbol index_name = sym_intern_cstr(AST_FOR_EACH_INDEX);
+    int depth = node->kw_for_each.depth;
+    int slot = node->kw_for_each.slot;
+    int32_t keys = chunk_add_var_ref(self->chunk, depth, slot, keys_name);
+    int32_t index =
+        chunk_add_var_ref(self->chunk, depth, slot + 1, index_name);
+
+    emit(self, OP_ENTER_SCOPE, 0, src_info);
+    ++self->scope_depth;
+
+    compile_expr(self, node->kw_for_each.map, false);
+    emit(self, OP_MAP_KEYS, 0, src_info);
+    emit_var_decl(
+        self, type_system_list(self->types, key_type), keys_name, slot,
+        src_info
+    );
+
+    emit(self, OP_INT, chunk_add_int(self->chunk, 0), src_info);
+    emit_var_decl(
+        self, self->types->builtin_int, index_name, slot + 1, src_info
+    );
+
+    size_t start = self->chunk->code.len;
+
+    emit(self, OP_GET_VAR, index, src_info);
+    emit(self, OP_GET_VAR, keys, src_info);
+    emit(self, OP_UNARY, TOKEN_HASHTAG, src_info);
+    emit(self, OP_BINARY, TOKEN_LESS, src_info);
+    size_t jump_end = emit(self, OP_JUMP_IF_FALSE, 0, src_info);
+
+    enter_loop(self);
+
+    emit(self, OP_ENTER_SCOPE, 0, src_info);
+    ++self->scope_depth;
+
+    emit(self, OP_GET_VAR, keys, src_info);
+    emit(self, OP_GET_VAR, index, src_info);
+    emit(self, OP_SUBSCRIPT, 0, src_info);
+    emit_var_decl(
+        self, key_type, var->param_decl.name->ident.name,
+        var->param_decl.name->ident.slot, var->tok.src_info
+    );
+
+    if (node->kw_for_each.body) {
+        compile_stmt(self, node->kw_for_each.body);
+    }
+
+    --self->scope_depth;
+    emit(self, OP_LEAVE_SCOPE, 1, src_info);
+
+    size_t iter = self->chunk->code.len;
+
+    emit(self, OP_GET_VAR, index, src_info);
+    emit(self, OP_UNARY, TOKEN_INC, src_info);
+    emit(self, OP_POP, 0, src_info);
+    emit(self, OP_JUMP, (int32_t) start, src_info);
+
+    size_t end = self->chunk->code.len;
+    patch_jump(self, jump_end, end);
+    leave_loop(self, end, iter);
+
+    --self->scope_depth;
+    emit(self, OP_LEAVE_SCOPE, 1, src_info);
+}
+
+static void compile_loop_jump(Compiler *self, const AstNode *node) {
+    LoopInfo *loop = &VEC_LAST(&self->loops, LoopInfo);
+    int depth = self->scope_depth - loop->scope_depth;
+
+    /* Close the scopes opened inside the loop body */
+    if (depth > 0) {
+        emit(self, OP_LEAVE_SCOPE, depth, node->tok.src_info);
+    }
+
+    size_t jump = emit(self, OP_JUMP, 0, node->tok.src_info);
+
+    if (node->kind == AST_NODE_BREAK) {
+        vec_push(&loop->breaks, &jump);
+    } else {
+        vec_push(&loop->continues, &jump);
+    }
+}
+
+/* The returned call of the function itself, or NULL */
+static const AstNode *
+find_tail_call(const Compiler *self, const AstNode *expr) {
+    while (expr && expr->kind == AST_NODE_GROUPING) {
+        expr = expr->grouping.expr;
+    }
+
+    if (self->fn && expr && expr->kind == AST_NODE_FN_CALL &&
+        expr->fn_call.name->ident.name == self->fn->fn_decl.name->ident.name) {
+        return expr;
+    }
+
+    return NULL;
+}
+
+static void compile_return(Compiler *self, const AstNode *node) {
+    const AstNode *tail_call = find_tail_call(self, node->kw_return.expr);
+
+    if (tail_call) {
+        compile_fn_call(self, tail_call, OP_TAIL_CALL);
+    } else if (node->kw_return.expr) {
+        compile_expr(self, node->kw_return.expr, false);
+        emit(self, OP_RETURN, 1, node->tok.src_info);
+    } else {
+        emit(self, OP_RETURN, 0, node->tok.src_info);
+    }
+}
+
+static void compile_stmt(Compiler *self, const AstNode *node) {
+    switch (node->kind) {
+    case AST_NODE_BLOCK:
+        compile_block(self, node);
+
+        break;
+    case AST_NODE_VAR_DECL:
+        compile_var_decl(self, node);
+
+        break;
+    case AST_NODE_FN_DECL:
+        compile_fn_decl(self, node);
+
+        break;
+    case AST_NODE_STRUCT_DECL:
+        /* the layout was registered by semantic checker */
+
+        break;
+    case AST_NODE_IF:
+        compile_if(self, node);
+
+        break;
+    case AST_NODE_WHILE:
+        compile_while(self, node);
+
+        break;
+    case AST_NODE_FOR:
+        compile_for(self, node);
+
+        break;
+    case AST_NODE_FOR_EACH:
+        compile_for_each(self, node);
+
+        break;
+    case AST_NODE_BREAK:
+    case AST_NODE_CONTINUE:
+        compile_loop_jump(self, node);
+
+        break;
+    case AST_NODE_RETURN:
+        compile_return(self, node);
+
+        break;
+    default:
+        compile_expr(self, node, false);
+        emit(self, OP_POP, 0, node->tok.src_info);
+
+        break;
+    }
+}
+
+void compiler_init(Compiler *self, TypeSystem *types, ConstPool *consts) {
+    self->types = types;
+    self->consts = consts;
+    self->chunk = NULL;
+    self->scope_depth = 0;
+    self->fn = NULL;
+
+    vec_init(&self->loops, sizeof(LoopInfo));
+}
+
+void compiler_deinit(Compiler *self) {
+    vec_deinit(&self->loops);
+}
+
+void compiler_compile(Compiler *self, const Ast *ast, Chunk *chunk) {
+    self->chunk = chunk;
+    self->scope_depth = 0;
+
+    const AstNode **nodes = ast->nodes.data;
+
+    for (size_t i = 0; i < ast->nodes.len; ++i) {
+        compile_stmt(self, nodes[i]);
+    }
+
+    SourceInfo src_info = {0};
+    emit(self, OP_END, 0, src_info);
+}
+
+void compiler_compile_expr(Compiler *self, const AstNode *node, Chunk *chunk) {
+    self->chunk = chunk;
+    self->scope_depth = 0;
+
+    compile_expr(self, node, false);
+
+    emit(self, OP_END, 0, node->tok.src_info);
+}
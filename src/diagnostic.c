@@ -173,6 +173,73 @@ const char *dmsg_to_str(const DiagnosticMessage *dmsg) {
     case DIAGNOSTIC_VOID_VAR:
         snprintf(g_buf, BUFFER_SIZE, "variable cannot be void");
 
+        break;
+    case DIAGNOSTIC_EXPECTED_MAP:
+        snprintf(
+            g_buf, BUFFER_SIZE, "expected map, but found %s",
+            dmsg->type_mismatch.found->name
+        );
+
+        break;
+    case DIAGNOSTIC_BAD_MAP_KEY_TYPE:
+        snprintf(
+            g_buf, BUFFER_SIZE, "map key must be int or string, but found %s",
+            dmsg->bad_index_type.found->name
+        );
+
+        break;
+    case DIAGNOSTIC_VOID_MAP_VALUE:
+        snprintf(g_buf, BUFFER_SIZE, "map value cannot be void");
+
+        break;
+    case DIAGNOSTIC_UNKNOWN_TYPE:
+        snprintf(g_buf, BUFFER_SIZE, "unknown type %s", dmsg->undef_sym.name);
+
+        break;
+    case DIAGNOSTIC_STRUCT_REDEFINITION:
+        snprintf(
+            g_buf, BUFFER_SIZE, "struct %s is already defined",
+            dmsg->struct_def.name
+        );
+
+        break;
+    case DIAGNOSTIC_STRUCT_BAD_PLACE:
+        snprintf(
+            g_buf, BUFFER_SIZE, "struct can be declared only at global scope"
+        );
+
+        break;
+    case DIAGNOSTIC_RECURSIVE_STRUCT:
+        snprintf(
+            g_buf, BUFFER_SIZE, "struct %s cannot contain itself",
+            dmsg->struct_def.name
+        );
+
+        break;
+    case DIAGNOSTIC_FIELD_REDECLARATION:
+        snprintf(
+            g_buf, BUFFER_SIZE, "field %s is already declared",
+            dmsg->field_redecl.name
+        );
+
+        break;
+    case DIAGNOSTIC_VOID_FIELD:
+        snprintf(g_buf, BUFFER_SIZE, "field cannot be void");
+
+        break;
+    case DIAGNOSTIC_EXPECTED_STRUCT:
+        snprintf(
+            g_buf, BUFFER_SIZE, "expected struct, but found %s",
+            dmsg->type_mismatch.found->name
+        );
+
+        break;
+    case DIAGNOSTIC_NO_SUCH_FIELD:
+        snprintf(
+            g_buf, BUFFER_SIZE, "struct %s has no field %s",
+            dmsg->no_field.type->name, dmsg->no_field.name
+        );
+
         break;
     }
 
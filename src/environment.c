@@ -18,13 +18,12 @@ add_fn(HashMap *funcs, Type *type, const char *name, FnBuiltin builtin) {
     Function *fn = mem_alloc(sizeof(*fn));
 
     fn->type = type;
-    fn->name = cstr_dup(name);
+    fn->name = sym_intern_cstr(name);
     fn->builtin = builtin;
-    fn->free_body = false;
     fn->is_builtin = true;
 
     vec_init(&fn->params, sizeof(FnParam));
-    hashmap_add(funcs, name, fn);
+    sym_map_add(funcs, fn->name, fn);
 }
 
 static void add_param(Function *fn, Type *type) {
@@ -35,13 +34,8 @@ static void add_param(Function *fn, Type *type) {
 }
 
 static void add_builtin_funcs(HashMap *funcs, TypeSystem *types) {
-    Type opt_int_descr = {TYPE_OPTION, NULL, {0}};
-    opt_int_descr.opt_type.type = types->builtin_int;
-    Type *opt_int = type_system_register(types, &opt_int_descr);
-
-    Type opt_string_descr = {TYPE_OPTION, NULL, {0}};
-    opt_string_descr.opt_type.type = types->builtin_string;
-    Type *opt_string = type_system_register(types, &opt_string_descr);
+    Type *opt_int = type_system_option(types, types->builtin_int);
+    Type *opt_string = type_system_option(types, types->builtin_string);
 
     Type *fn_ret_types[] = {
         types->builtin_void,   /* print */
@@ -92,30 +86,62 @@ static void add_builtin_funcs(HashMap *funcs, TypeSystem *types) {
     add_param(ord_fn, types->builtin_string);       /* string ch */
 }
 
-void env_init(Environment *self, TypeSystem *types) {
-    vec_init(&self->scopes, sizeof(Scope));
+/* Take a scope from the pool or allocate a new one */
+static Scope *push_scope(Environment *self) {
+    Scope *scope;
+
+    if (self->free_scopes.len > 0) {
+        scope = VEC_LAST(&self->free_scopes, Scope *);
+        vec_pop(&self->free_scopes);
+    } else {
+        scope = mem_alloc(sizeof(*scope));
+        scope_init(scope);
+    }
+
+    vec_push(&self->scopes, &scope);
+
+    return scope;
+}
+
+/* Clear the innermost scope and return it to the pool */
+static void pop_scope(Environment *self) {
+    Scope *scope = VEC_LAST(&self->scopes, Scope *);
 
-    Scope global_scope;
+    scope_clear(scope);
+    vec_pop(&self->scopes);
+    vec_push(&self->free_scopes, &scope);
+}
 
-    scope_init(&global_scope);
-    vec_push(&self->scopes, &global_scope);
+void env_init(Environment *self, TypeSystem *types) {
+    vec_init(&self->scopes, sizeof(Scope *));
+    vec_init(&self->free_scopes, sizeof(Scope *));
 
-    self->global_scope = &VEC_LAST(&self->scopes, Scope);
-    self->curr_scope = &VEC_LAST(&self->scopes, Scope);
+    self->global_scope = push_scope(self);
+    self->curr_scope = self->global_scope;
     self->caller_scope = NULL;
     self->old_scope = NULL;
     self->curr_fn = NULL;
     self->old_fn = NULL;
+    self->frame_base = 1;
+    self->fn_epoch = 1;
 
     hashmap_init(&self->funcs);
     add_builtin_funcs(&self->funcs, types);
 }
 
 void env_deinit(Environment *self) {
-    Scope *scopes = self->scopes.data;
+    while (self->scopes.len > 1) {
+        pop_scope(self);
+    }
 
-    for (size_t i = 0; i < self->scopes.len; ++i) {
-        scope_deinit(&scopes[i]);
+    scope_deinit(self->global_scope);
+    free(self->global_scope);
+
+    Scope **free_scopes = self->free_scopes.data;
+
+    for (size_t i = 0; i < self->free_scopes.len; ++i) {
+        scope_deinit(free_scopes[i]);
+        free(free_scopes[i]);
     }
 
     for (HashMapIter it = hashmap_iter(&self->funcs); it.bucket != NULL;
@@ -127,64 +153,63 @@ void env_deinit(Environment *self) {
     }
 
     vec_deinit(&self->scopes);
+    vec_deinit(&self->free_scopes);
     hashmap_deinit(&self->funcs);
 }
 
-Variable *env_find_var(const Environment *self, const char *name) {
-    Variable *var = NULL;
+Variable *env_find_var(const Environment *self, Symbol name) {
+    int depth;
 
-    for (size_t i = self->scopes.len - 1; i >= 1; --i) {
-        const Scope *scopes = self->scopes.data;
-        const Scope *scope = &scopes[i];
+    return env_resolve_var(self, name, &depth);
+}
 
-        if (scope == self->caller_scope &&
-            self->caller_scope != self->global_scope) {
-            break;
-        }
+/*
+ * Find the variable visible from the current scope and compute its depth.
+ * Blocks enclosing the current function are not visible.
+ */
+Variable *
+env_resolve_var(const Environment *self, Symbol name, int *depth) {
+    Scope *const *scopes = self->scopes.data;
 
-        var = hashmap_get(&scope->vars, name);
+    for (size_t i = self->scopes.len - 1; i >= self->frame_base; --i) {
+        Variable *var = sym_map_get(&scopes[i]->vars, name);
 
         if (var) {
-            break;
+            *depth = (int) (i - self->frame_base);
+
+            return var;
         }
     }
 
-    if (!var) {
-        var = hashmap_get(&self->global_scope->vars, name);
-    }
+    *depth = VAR_GLOBAL_DEPTH;
 
-    return var;
+    return sym_map_get(&self->global_scope->vars, name);
 }
 
-Function *env_find_fn(const Environment *self, const char *name) {
-    return hashmap_get(&self->funcs, name);
+Function *env_find_fn(const Environment *self, Symbol name) {
+    return sym_map_get(&self->funcs, name);
 }
 
 void env_reset(Environment *self) {
-    Scope *scopes = self->scopes.data;
-
-    for (size_t i = 1; i < self->scopes.len; ++i) {
-        scope_deinit(&scopes[i]);
+    while (self->scopes.len > 1) {
+        pop_scope(self);
     }
 
-    scope_clear(&scopes[0]);
+    scope_clear(self->global_scope);
 
-    self->global_scope = &VEC_LAST(&self->scopes, Scope);
-    self->curr_scope = &VEC_LAST(&self->scopes, Scope);
+    self->curr_scope = self->global_scope;
     self->caller_scope = NULL;
     self->old_scope = NULL;
     self->curr_fn = NULL;
     self->old_fn = NULL;
-
-    for (size_t i = 1; i < self->scopes.len; ++i) {
-        vec_pop(&self->scopes);
-    }
+    self->frame_base = 1;
+    ++self->fn_epoch;
 
     for (HashMapIter it = hashmap_iter(&self->funcs); it.bucket != NULL;
          hashmap_iter_next(&it)) {
         Function *fn = it.bucket->value;
 
-        hashmap_remove(&self->funcs, fn->name);
+        sym_map_remove(&self->funcs, fn->name);
         fn_deinit(fn);
 
         free(fn);
@@ -192,10 +217,7 @@ void env_reset(Environment *self) {
 }
 
 Scope *env_enter_scope(Environment *self) {
-    Scope *new_scope = vec_emplace(&self->scopes);
-    scope_init(new_scope);
-
-    self->curr_scope = &VEC_LAST(&self->scopes, Scope);
+    self->curr_scope = push_scope(self);
 
     return self->curr_scope;
 }
@@ -205,39 +227,52 @@ void env_leave_scope(Environment *self) {
         return;
     }
 
-    scope_deinit(self->curr_scope);
-    vec_pop(&self->scopes);
-    self->curr_scope = &VEC_LAST(&self->scopes, Scope);
+    pop_scope(self);
+    self->curr_scope = VEC_LAST(&self->scopes, Scope *);
 }
 
 Scope *env_enter_fn(Environment *self, Function *fn) {
     self->old_scope = self->curr_scope;
 
-    Scope *fn_scope = vec_emplace(&self->scopes);
-    scope_init(fn_scope);
+    Scope *fn_scope = push_scope(self);
 
     self->old_fn = self->curr_fn;
     self->curr_scope = fn_scope;
     self->curr_fn = fn;
+    self->frame_base = self->scopes.len - 1;
 
     return fn_scope;
 }
 
 void env_leave_fn(Environment *self) {
-    scope_deinit(self->curr_scope);
-    vec_pop(&self->scopes);
+    pop_scope(self);
+    self->curr_scope = VEC_LAST(&self->scopes, Scope *);
 
     self->curr_fn = self->old_fn;
 }
 
 void env_add_fn(Environment *self, Function *fn) {
-    hashmap_add(&self->funcs, fn->name, fn);
+    sym_map_add(&self->funcs, fn->name, fn);
+    ++self->fn_epoch;
 }
 
 void env_add_local_var(Environment *self, Variable *var) {
     scope_add_var(self->curr_scope, var);
 }
 
+/* The variable keeps its slot, so it can be used for copying globals */
 void env_add_global_var(Environment *self, Variable *var) {
-    scope_add_var(self->global_scope, var);
+    scope_register_var(self->global_scope, var);
+}
+
+/*
+ * Put a variable with resolved slot into the current scope. Only globals can be
+ * found by name afterwards.
+ */
+void env_bind_var(Environment *self, Variable *var) {
+    if (self->curr_scope == self->global_scope) {
+        scope_register_var(self->curr_scope, var);
+    } else {
+        scope_set_var(self->curr_scope, var);
+    }
 }
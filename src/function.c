@@ -16,18 +16,16 @@ void fn_deinit(Function *self) {
         FnParam *param = &params[i];
 
         param->type = NULL;
-
-        free(param->name);
         param->name = NULL;
     }
 
     vec_deinit(&self->params);
 
-    if (self->free_body) {
-        astnode_destroy(self->body);
-        self->body = NULL;
+    if (!self->is_builtin && self->chunk) {
+        chunk_deinit(self->chunk);
+        free(self->chunk);
+        self->chunk = NULL;
     }
 
-    free(self->name);
     self->name = NULL;
 }
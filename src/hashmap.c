@@ -11,9 +11,23 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define TOMBSTONE ((void *)0x1)
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define MAX_LOAD 0.7
 
+/*
+ * A free bucket has the high bit of its control byte set, a full one stores
+ * the low 7 bits of its key's hash there (H2). The rest of the hash (H1)
+ * selects the bucket the probing starts from.
+ */
+#define CTRL_EMPTY ((uint8_t) 0x80)
+#define CTRL_DELETED ((uint8_t) 0xfe)
+
+#define H1(_hash) ((size_t) ((_hash) >> 7))
+#define H2(_hash) ((uint8_t) ((_hash) & 0x7f))
+
 /*
  * Details about the hash function and its parameters can be found here:
  * http://www.isthe.com/chongo/tech/comp/fnv/
@@ -22,7 +36,7 @@
 #define FNV1A_OFFSET_BASIS 2166136261
 #define FNV1A_PRIME 16777619
 
-static HashType calc_hash(const char *key, size_t len) {
+HashType hashmap_hash(const char *key, size_t len) {
     HashType hash = FNV1A_OFFSET_BASIS;
 
     for (size_t i = 0; i < len; ++i) {
@@ -33,142 +47,271 @@ static HashType calc_hash(const char *key, size_t len) {
     return hash;
 }
 
-static Bucket *find_bucket(Bucket *buckets, size_t cap, const char *key) {
-    Bucket *bucket = NULL;
-    Bucket *tombstone = NULL;
-
-    /* HashType idx = calc_hash(key, strlen(key)) % cap;
-     *
-     * OPTIMIZATION: since the capacity is always a power of 2, we can use
-     * bitwise AND and capacity minus one to get the remainder of division.
-     * Bitwise instructions are very cheap, especially when compared to heavy
-     * operations like modulo.
-     */
-    HashType idx = calc_hash(key, strlen(key)) & (cap - 1);
-
-    /* Linear probing */
-    for (;;) {
-        bucket = &buckets[idx];
-
-        if (!bucket->key) {
-            if (!bucket->value) {
-                return tombstone ? tombstone : bucket;
-            } else if (bucket->value == TOMBSTONE && !tombstone) {
-                tombstone = bucket;
+/* Bit i is set if the i-th bucket of the group matched */
+typedef uint32_t GroupMask;
+
+static GroupMask group_match(const uint8_t *group, uint8_t ctrl) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i *) group);
+    __m128i match = _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) ctrl));
+
+    return (GroupMask) _mm_movemask_epi8(match);
+#else
+    GroupMask mask = 0;
+
+    for (unsigned i = 0; i < HASHMAP_GROUP_WIDTH; ++i) {
+        mask |= (GroupMask) (group[i] == ctrl) << i;
+    }
+
+    return mask;
+#endif
+}
+
+/* Empty or deleted buckets */
+static GroupMask group_match_free(const uint8_t *group) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i *) group);
+
+    return (GroupMask) _mm_movemask_epi8(bytes);
+#else
+    GroupMask mask = 0;
+
+    for (unsigned i = 0; i < HASHMAP_GROUP_WIDTH; ++i) {
+        mask |= (GroupMask) (group[i] >> 7) << i;
+    }
+
+    return mask;
+#endif
+}
+
+static size_t lowest_bit(GroupMask mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t) __builtin_ctz(mask);
+#else
+    size_t i = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++i;
+    }
+
+    return i;
+#endif
+}
+
+static void set_ctrl(HashMap *self, size_t idx, uint8_t ctrl) {
+    self->ctrl[idx] = ctrl;
+
+    /* Keep the copy of the first group in sync */
+    if (idx < HASHMAP_GROUP_WIDTH) {
+        self->ctrl[self->cap + idx] = ctrl;
+    }
+}
+
+/*
+ * Groups are probed quadratically: the distance to the next one grows by a
+ * group every step, which visits every group when the capacity is a power
+ * of 2. The table always has an empty bucket, so probing terminates.
+ */
+
+/* Returns the capacity if the key is not in the map */
+static size_t
+find_bucket(const HashMap *self, const char *key, size_t len, HashType hash) {
+    size_t mask = self->cap - 1;
+    size_t pos = H1(hash) & mask;
+
+    for (size_t stride = HASHMAP_GROUP_WIDTH;; stride += HASHMAP_GROUP_WIDTH) {
+        const uint8_t *group = &self->ctrl[pos];
+
+        for (GroupMask m = group_match(group, H2(hash)); m; m &= m - 1) {
+            size_t idx = (pos + lowest_bit(m)) & mask;
+            const Bucket *bucket = &self->buckets[idx];
+
+            if (bucket->hash == hash && bucket->len == len &&
+                (bucket->key == key || memcmp(bucket->key, key, len) == 0)) {
+                return idx;
             }
-        } else if (strcmp(bucket->key, key) == 0) {
-            break;
         }
 
-        idx = (idx + 1) & (cap - 1);
+        if (group_match(group, CTRL_EMPTY)) {
+            return self->cap;
+        }
+
+        pos = (pos + stride) & mask;
+    }
+}
+
+static size_t find_free_bucket(const HashMap *self, HashType hash) {
+    size_t mask = self->cap - 1;
+    size_t pos = H1(hash) & mask;
+
+    for (size_t stride = HASHMAP_GROUP_WIDTH;; stride += HASHMAP_GROUP_WIDTH) {
+        GroupMask m = group_match_free(&self->ctrl[pos]);
+
+        if (m) {
+            return (pos + lowest_bit(m)) & mask;
+        }
+
+        pos = (pos + stride) & mask;
+    }
+}
+
+/* Buckets and control bytes share one allocation */
+static bool alloc_table(HashMap *self, size_t cap) {
+    size_t buckets_size = cap * sizeof(Bucket);
+    char *table = malloc(buckets_size + cap + HASHMAP_GROUP_WIDTH);
+
+    if (!table) {
+        return false;
     }
 
-    return bucket;
+    self->buckets = (Bucket *) table;
+    self->ctrl = (uint8_t *) table + buckets_size;
+    self->cap = cap;
+    self->size = 0;
+    self->deleted = 0;
+
+    memset(self->ctrl, CTRL_EMPTY, cap + HASHMAP_GROUP_WIDTH);
+
+    return true;
 }
 
 static bool should_resize(const HashMap *self) {
-    return self->size >= (size_t) ((double) self->cap * MAX_LOAD);
+    return self->size + self->deleted >=
+           (size_t) ((double) self->cap * MAX_LOAD);
 }
 
-static bool grow(HashMap *self) {
-    size_t new_cap = self->cap * 2;
-    Bucket *new_buckets = mem_alloc(new_cap * sizeof(Bucket));
+/* Grow the table, or only drop the deleted buckets if they take most of it */
+static bool rehash(HashMap *self) {
+    HashMap old = *self;
+    size_t new_cap = self->size >= self->deleted ? self->cap * 2 : self->cap;
+
+    if (!alloc_table(self, new_cap)) {
+        *self = old;
 
-    if (!new_buckets) {
         return false;
     }
 
-    /* rehash */
-    for (size_t i = 0; i < self->cap; ++i) {
-        Bucket *bucket = &self->buckets[i];
-
-        if (!bucket->key) {
+    for (size_t i = 0; i < old.cap; ++i) {
+        if (old.ctrl[i] & CTRL_EMPTY) {
             continue;
         }
 
-        Bucket *dest_bucket = find_bucket(new_buckets, new_cap, bucket->key);
-        dest_bucket->key = bucket->key;
-        dest_bucket->value = bucket->value;
+        const Bucket *bucket = &old.buckets[i];
+        size_t idx = find_free_bucket(self, bucket->hash);
+
+        set_ctrl(self, idx, H2(bucket->hash));
+        self->buckets[idx] = *bucket;
     }
 
-    free(self->buckets);
-    self->buckets = new_buckets;
-    self->cap = new_cap;
+    self->size = old.size;
+    free(old.buckets);
 
     return true;
 }
 
 bool hashmap_init(HashMap *self) {
-    self->buckets = calloc(HASHMAP_DEFAULT_CAP, sizeof(Bucket));
-
-    if (!self->buckets) {
-        return false;
-    }
+    return hashmap_init_cap(self, HASHMAP_DEFAULT_CAP);
+}
 
-    self->size = 0;
-    self->cap = HASHMAP_DEFAULT_CAP;
+bool hashmap_init_cap(HashMap *self, size_t cap) {
+    self->buckets = NULL;
+    self->ctrl = NULL;
 
-    return true;
+    return alloc_table(self, cap);
 }
 
 void hashmap_deinit(HashMap *self) {
     free(self->buckets);
     self->buckets = NULL;
+    self->ctrl = NULL;
 
     self->size = 0;
+    self->deleted = 0;
     self->cap = 0;
 }
 
-bool hashmap_add(HashMap *self, const char *key, void *value) {
-    if (should_resize(self) && !grow(self)) {
-        return false;
-    }
+bool hashmap_add_hashed(
+    HashMap *self, const char *key, size_t len, HashType hash, void *value
+) {
+    size_t idx = find_bucket(self, key, len, hash);
 
-    Bucket *bucket = find_bucket(self->buckets, self->cap, key);
-    bool new_bucket = !bucket->key;
+    if (idx == self->cap) {
+        if (should_resize(self) && !rehash(self)) {
+            return false;
+        }
 
-    bucket->key = key;
-    bucket->value = value;
+        idx = find_free_bucket(self, hash);
 
-    if (new_bucket) {
+        if (self->ctrl[idx] == CTRL_DELETED) {
+            --self->deleted;
+        }
+
+        set_ctrl(self, idx, H2(hash));
         ++self->size;
     }
 
+    Bucket *bucket = &self->buckets[idx];
+
+    bucket->key = key;
+    bucket->value = value;
+    bucket->hash = hash;
+    bucket->len = (uint32_t) len;
+
     return true;
 }
 
-void hashmap_remove(HashMap *self, const char *key) {
+void hashmap_remove_hashed(
+    HashMap *self, const char *key, size_t len, HashType hash
+) {
     if (self->size == 0) {
         return;
     }
 
-    Bucket *bucket = find_bucket(self->buckets, self->cap, key);
+    size_t idx = find_bucket(self, key, len, hash);
 
-    if (bucket->key) {
-        bucket->key = NULL;
-        bucket->value = TOMBSTONE;
+    if (idx < self->cap) {
+        set_ctrl(self, idx, CTRL_DELETED);
 
         --self->size;
+        ++self->deleted;
     }
 }
 
-void *hashmap_get(const HashMap *self, const char *key) {
+void *hashmap_get_hashed(
+    const HashMap *self, const char *key, size_t len, HashType hash
+) {
     if (self->size == 0) {
         return NULL;
     }
 
-    Bucket *bucket = find_bucket(self->buckets, self->cap, key);
+    size_t idx = find_bucket(self, key, len, hash);
 
-    if (bucket->key && strcmp(bucket->key, key) == 0) {
-        return bucket->value;
-    }
+    return idx < self->cap ? self->buckets[idx].value : NULL;
+}
 
-    return NULL;
+bool hashmap_add(HashMap *self, const char *key, void *value) {
+    size_t len = strlen(key);
+
+    return hashmap_add_hashed(self, key, len, hashmap_hash(key, len), value);
+}
+
+void hashmap_remove(HashMap *self, const char *key) {
+    size_t len = strlen(key);
+
+    hashmap_remove_hashed(self, key, len, hashmap_hash(key, len));
+}
+
+void *hashmap_get(const HashMap *self, const char *key) {
+    size_t len = strlen(key);
+
+    return hashmap_get_hashed(self, key, len, hashmap_hash(key, len));
 }
 
 void hashmap_clear(HashMap *self) {
-    memset(self->buckets, 0, self->cap * sizeof(Bucket));
+    memset(self->ctrl, CTRL_EMPTY, self->cap + HASHMAP_GROUP_WIDTH);
     self->size = 0;
+    self->deleted = 0;
 }
 
 HashMapIter hashmap_iter(HashMap *self) {
@@ -180,9 +323,11 @@ HashMapIter hashmap_iter(HashMap *self) {
 
 Bucket *hashmap_iter_next(HashMapIter *self) {
     while (self->idx < self->map->cap) {
-        self->bucket = &self->map->buckets[self->idx++];
+        size_t idx = self->idx++;
+
+        if (!(self->map->ctrl[idx] & CTRL_EMPTY)) {
+            self->bucket = &self->map->buckets[idx];
 
-        if (self->bucket->key) {
             return self->bucket;
         }
     }
@@ -5,11 +5,12 @@
  * (see LICENSE.md in the root of project).
  */
 
-#include <monolog/ast.h>
 #include <monolog/builtin_funcs.h>
+#include <monolog/bytecode.h>
+#include <monolog/compiler.h>
 #include <monolog/expr_result.h>
 #include <monolog/interp.h>
-#include <monolog/stmt_result.h>
+#include <monolog/rc.h>
 #include <monolog/utils.h>
 
 #include <assert.h>
@@ -28,28 +29,6 @@
     val.i = _op((_v1)->i);                                                     \
     break
 
-#define EXPR_RETURN_ON_HALT(_node)                                             \
-    if (self->had_error && self->halt) {                                       \
-        ExprResult __expr_res = {EXPR_ERROR, .node = _node, {0}};              \
-                                                                               \
-        return __expr_res;                                                     \
-    } else if (self->halt) {                                                   \
-        ExprResult __expr_res = {EXPR_HALT, .node = _node, {0}};               \
-                                                                               \
-        return __expr_res;                                                     \
-    }
-
-#define STMT_RETURN_ON_HALT(_node)                                             \
-    if (self->had_error && self->halt) {                                       \
-        StmtResult __stmt_res = {STMT_ERROR, .node = _node, {0}};              \
-                                                                               \
-        return __stmt_res;                                                     \
-    } else if (self->halt) {                                                   \
-        StmtResult __stmt_res = {STMT_HALT, .node = _node, {0}};               \
-                                                                               \
-        return __stmt_res;                                                     \
-    }
-
 #define UNREACHABLE()                                                          \
     fprintf(                                                                   \
         stderr,                                                                \
@@ -84,8 +63,68 @@ error(Interpreter *self, SourceInfo src_info, const char *fmt, ...) {
     }
 }
 
-static Value expr_get_value(const Interpreter *self, ExprResult *expr) {
-    Value err_val = {self->types->error_type, NULL, {0}};
+/* The key of a map slot, borrowed from the subscript */
+static Value map_slot_key(const ExprResult *expr) {
+    Value key = {expr->map_slot.map->type->map_type.key, {0}};
+
+    if (key.type->id == TYPE_STRING) {
+        key.s = expr->map_slot.key.s;
+    } else {
+        key.i = expr->map_slot.key.i;
+    }
+
+    return key;
+}
+
+/* Result of looking up a missing key */
+static Value map_missing_value(const Interpreter *self, const ValueMap *map) {
+    Type *type = type_system_option(self->types, map->type->map_type.value);
+    Value val = {type->opt_type.empty, {0}};
+
+    return val;
+}
+
+static void clone_value(
+    Interpreter *self, Value *dest, Type *dest_type, const Value *src
+);
+static void add_temp(Interpreter *self, const Value *val);
+
+/* The element gets a struct of its own, which lives until the statement
+ * ends */
+static Value materialize_struct(Interpreter *self, ExprResult *expr) {
+    Type *type = expr->struct_ref.type;
+    const Value *src = expr->struct_ref.fields;
+    Value val = {type, {0}};
+    val.fields = value_new_struct(type);
+
+    for (size_t i = 0; i < value_struct_len(type); ++i) {
+        clone_value(self, &val.fields[i], src[i].type, &src[i]);
+    }
+
+    add_temp(self, &val);
+
+    expr->kind = EXPR_VALUE;
+    expr->val = val;
+
+    return val;
+}
+
+/* The value of the variable, or the option its parameter refers to */
+static Value *var_value(Variable *var) {
+    if (var->alias_list) {
+        if (var->alias_idx < var->alias_list->len) {
+            return &((Value *) var->alias_list->data)[var->alias_idx];
+        }
+
+        /* the element has been removed */
+        return &var->val;
+    }
+
+    return var->alias ? var->alias : &var->val;
+}
+
+static Value expr_get_value(Interpreter *self, ExprResult *expr) {
+    Value err_val = {self->types->error_type, {0}};
 
     switch (expr->kind) {
     case EXPR_ERROR:
@@ -94,167 +133,189 @@ static Value expr_get_value(const Interpreter *self, ExprResult *expr) {
     case EXPR_VALUE:
         return expr->val;
     case EXPR_VAR:
-        return expr->var->val;
+        return *var_value(expr->var);
     case EXPR_REF:
         return *expr->ref;
     case EXPR_CHAR_REF: {
-        Value val = {self->types->builtin_int, self->env.curr_scope, {0}};
+        Value val = {self->types->builtin_int, {0}};
         val.i = *expr->char_ref;
 
         return val;
     }
+    case EXPR_INT_REF: {
+        Value val = {self->types->builtin_int, {0}};
+        val.i = *expr->int_ref;
+
+        return val;
+    }
+    case EXPR_OPT_REF:
+        return value_opt_get(expr->opt_ref);
+    case EXPR_MAP_SLOT: {
+        Value key = map_slot_key(expr);
+        MapEntry *entry = value_map_find(expr->map_slot.map, &key);
+
+        return entry ? entry->val : map_missing_value(self, expr->map_slot.map);
+    }
+    case EXPR_STRUCT_REF:
+        return materialize_struct(self, expr);
     }
 
     /* satisfy gcc */
     return err_val;
 }
 
-static void expr_set_value(ExprResult *expr, const Value *val) {
-    switch (expr->kind) {
-    case EXPR_ERROR:
-    case EXPR_HALT:
-        break;
-    case EXPR_VALUE:
-        expr->val = *val;
-
-        break;
-    case EXPR_VAR:
-        expr->var->val = *val;
-
-        break;
-    case EXPR_REF:
-        *expr->ref = *val;
-
-        break;
-    case EXPR_CHAR_REF:
-        assert(val->type->id == TYPE_INT);
+/* The payload of the inner value is moved into the option */
+static void set_opt_payload(Value *opt, const Value *inner) {
+    Type *type = opt->type;
 
-        *expr->char_ref = (char) val->i;
-
-        break;
-    }
+    *opt = *inner;
+    opt->type = type;
 }
 
-static void clone_value(
-    Interpreter *self, Value *dest, Type *dest_type, const Value *src,
-    Scope *scope
-);
-
 static void make_opt(
-    Interpreter *self, Value *dest, Type *dest_type, const Value *val,
-    Scope *scope
+    Interpreter *self, Value *dest, Type *dest_type, const Value *val
 ) {
     assert(type_convertable(val->type, dest_type));
 
-    dest->type = dest_type;
-    dest->scope = scope;
+    /* dest_type may be the type of an empty value */
+    dest_type = dest_type->opt_type.present;
+    dest->type = dest_type->opt_type.empty;
     dest->opt.val = NULL;
 
-    if (!val || val->type->id == TYPE_NIL) {
+    if (val->type->id == TYPE_NIL) {
         return;
     }
 
-    Type *inner_type = dest->type->opt_type.type;
-    Value *inner = scope_new_value(scope, inner_type);
+    Type *inner_type = dest_type->opt_type.type;
+    Value src = *val;
 
     if (val->type->id == TYPE_OPTION && type_equal(val->type, dest_type)) {
-        if (val->opt.val) {
-            assert(type_equal(val->opt.val->type, inner_type));
-
-            clone_value(self, inner, inner_type, val->opt.val, scope);
-        } else {
-            inner = NULL;
+        if (!value_opt_is_present(val)) {
+            return;
         }
-    } else {
-        assert(type_equal(val->type, inner_type));
 
-        clone_value(self, inner, inner_type, val, scope);
+        src = value_opt_get(val);
     }
 
-    dest->opt.val = inner;
+    assert(type_equal(src.type, inner_type));
+
+    dest->type = dest_type;
+
+    if (value_opt_is_boxed(dest_type)) {
+        /* Every boxed option gets its own box */
+        Value *inner = value_new_box(inner_type);
+        clone_value(self, inner, inner_type, &src);
+
+        dest->opt.val = inner;
+    } else {
+        Value inner = {inner_type, {0}};
+        clone_value(self, &inner, inner_type, &src);
+
+        set_opt_payload(dest, &inner);
+    }
 }
 
-static void implicitly_clone_value(
-    Interpreter *self, Value *dest, const Value *src, Scope *scope
-) {
+static void
+implicitly_clone_value(Interpreter *self, Value *dest, const Value *src) {
     if (dest->type->id == TYPE_OPTION) {
-        make_opt(self, dest, dest->type, src, scope);
+        make_opt(self, dest, dest->type, src);
     } else {
-        clone_value(self, dest, dest->type, src, scope);
+        clone_value(self, dest, dest->type, src);
     }
 }
 
-static Value shallowly_clone_value(Interpreter *self, const Value *val) {
-    UNUSED(self);
-
-    Value arg = {val->type, val->scope, {0}};
-
-    switch (val->type->id) {
-    case TYPE_INT:
-        arg.i = val->i;
+/*
+ * Give dest a copy of the object of src. Elements of a list, entries of a map
+ * and fields of a struct aren't copied, they're shared with the original.
+ */
+static void copy_object(Interpreter *self, Value *dest, const Value *src) {
+    dest->type = src->type;
 
-        break;
+    switch (src->type->id) {
     case TYPE_STRING:
-        arg.s = val->s;
+        dest->s = value_new_string();
+        str_dup_n(dest->s, str_data(src->s), str_len(src->s));
 
         break;
-    case TYPE_OPTION:
-        arg.opt.val = val->opt.val;
+    case TYPE_LIST: {
+        Vector *values = value_new_list(src->type);
+        const Vector *src_list = src->list.values;
 
-        break;
-    case TYPE_LIST:
-        arg.list.values = val->list.values;
+        if (value_list_is_unboxed(src->type)) {
+            vec_reserve(values, src_list->len);
+            memcpy(values->data, src_list->data, src_list->len * sizeof(Int));
+            values->len = src_list->len;
 
-        break;
-    case TYPE_NIL:
-    case TYPE_VOID:
-        break;
-    case TYPE_ERROR:
-        UNREACHABLE();
-    }
+            dest->list.values = values;
 
-    return arg;
-}
+            break;
+        }
 
-static void shallowly_implicitly_clone_value(
-    Interpreter *self, Value *dest, const Value *src, Scope *scope
-) {
-    if (dest->type->id == TYPE_OPTION && src->type->id != TYPE_OPTION &&
-        type_convertable(src->type, dest->type)) {
-        make_opt(self, dest, dest->type, src, scope);
-    } else {
-        *dest = shallowly_clone_value(self, src);
-    }
-}
+        const Value *src_values = src_list->data;
+        size_t elem_len = 1;
 
-static bool
-clone_list(Interpreter *self, Value *dest, const Value *src, Scope *scope) {
-    assert(dest->type);
-    assert(type_convertable(dest->type, src->type));
+        if (value_list_is_inline(src->type)) {
+            elem_len = value_struct_len(src->type->list_type.type);
+        }
 
-    Vector *values = scope_new_list(scope);
+        for (size_t i = 0; i < src_list->len; ++i) {
+            Value *elem = vec_emplace(values);
 
-    if (dest->list.values) {
-        vec_deinit(dest->list.values);
+            for (size_t j = 0; j < elem_len; ++j) {
+                const Value *src_val = &src_values[i * elem_len + j];
+
+                clone_value(self, &elem[j], src_val->type, src_val);
+            }
+        }
+
+        dest->list.values = values;
+
+        break;
     }
+    case TYPE_MAP: {
+        ValueMap *map = value_new_map(src->type);
+        const MapEntry **entries = (const MapEntry **) src->map->entries.data;
 
-    dest->list.values = values;
+        for (size_t i = 0; i < src->map->entries.len; ++i) {
+            const MapEntry *src_entry = entries[i];
+            Value key;
+            clone_value(self, &key, src_entry->key.type, &src_entry->key);
 
-    const Value *src_values = src->list.values->data;
+            MapEntry *entry = value_map_add(map, &key);
+            clone_value(
+                self, &entry->val, src_entry->val.type, &src_entry->val
+            );
+        }
 
-    for (size_t i = 0; i < src->list.values->len; ++i) {
-        Value *elem = vec_emplace(values);
-        elem->type = src_values[i].type;
+        dest->map = map;
 
-        implicitly_clone_value(self, elem, &src_values[i], scope);
+        break;
     }
+    case TYPE_STRUCT: {
+        Value *fields = value_new_struct(src->type);
 
-    return true;
+        for (size_t i = 0; i < value_struct_len(src->type); ++i) {
+            const Value *field = &src->fields[i];
+
+            clone_value(self, &fields[i], field->type, field);
+        }
+
+        dest->fields = fields;
+
+        break;
+    }
+    default:
+        UNREACHABLE();
+    }
 }
 
+/*
+ * dest gets its own reference to the object of src. Strings, lists, maps and
+ * structs are shared: the copy is made when one of the values is modified
+ * (see make_unique()).
+ */
 static void clone_value(
-    Interpreter *self, Value *dest, Type *dest_type, const Value *src,
-    Scope *scope
+    Interpreter *self, Value *dest, Type *dest_type, const Value *src
 ) {
     switch (src->type->id) {
     case TYPE_ERROR:
@@ -266,21 +327,30 @@ static void clone_value(
 
         break;
     case TYPE_STRING:
-        dest->type = self->types->builtin_string;
-        dest->s = scope_new_string(scope);
-        str_dup_n(dest->s, src->s->data, src->s->len);
+    case TYPE_LIST:
+    case TYPE_MAP:
+    case TYPE_STRUCT:
+        assert(type_convertable(src->type, dest_type));
+
+        if (value_is_pinned(src)) {
+            copy_object(self, dest, src);
+        } else {
+            dest->type = src->type;
+            dest->s = src->s;
+            dest->list.values = src->list.values;
+            dest->map = src->map;
+            dest->fields = src->fields;
+
+            value_retain(dest);
+        }
 
         break;
     case TYPE_VOID:
         dest->type = self->types->builtin_void;
 
-        break;
-    case TYPE_LIST:
-        clone_list(self, dest, src, scope);
-
         break;
     case TYPE_OPTION:
-        make_opt(self, dest, dest_type, src, scope);
+        make_opt(self, dest, dest_type, src);
 
         break;
     case TYPE_NIL:
@@ -290,6 +360,79 @@ static void clone_value(
     }
 }
 
+/* The reference held by the value is released at the end of the statement */
+static void add_temp(Interpreter *self, const Value *val) {
+    vec_push(&self->temps, val);
+}
+
+static void release_temps(Interpreter *self) {
+    Value *temps = self->temps.data;
+
+    while (self->temps.len > self->temps_base) {
+        value_release(&temps[--self->temps.len]);
+    }
+}
+
+/*
+ * Replace a shared string, list, map or struct with a copy which can be
+ * modified in place. The copy takes over the reference of the value.
+ */
+static void make_unique(Interpreter *self, ExprResult *expr) {
+    Value *val = NULL;
+
+    switch (expr->kind) {
+    case EXPR_VAR:
+        val = &expr->var->val;
+
+        break;
+    case EXPR_REF:
+        val = expr->ref;
+
+        break;
+    case EXPR_VALUE:
+        val = &expr->val;
+
+        break;
+    case EXPR_OPT_REF: {
+        Value inner = value_opt_get(expr->opt_ref);
+
+        if (value_is_shared(&inner)) {
+            Value copy;
+            copy_object(self, &copy, &inner);
+
+            value_release(&inner);
+            set_opt_payload(expr->opt_ref, &copy);
+        }
+
+        return;
+    }
+    default:
+        return;
+    }
+
+    TypeId id = val->type->id;
+
+    if ((id != TYPE_STRING && id != TYPE_LIST && id != TYPE_MAP &&
+         id != TYPE_STRUCT) ||
+        !value_is_shared(val)) {
+        return;
+    }
+
+    Value copy = *val;
+    copy_object(self, &copy, val);
+
+    if (expr->kind == EXPR_VALUE) {
+        /* the temporary doesn't own the original */
+        add_temp(self, &copy);
+    } else if (expr->kind == EXPR_VAR && expr->var->is_borrowed) {
+        expr->var->is_borrowed = false;
+    } else {
+        value_release(val);
+    }
+
+    *val = copy;
+}
+
 static bool value_equal(const Value *v1, const Value *v2) {
     if (!type_equal(v1->type, v2->type)) {
         return false;
@@ -305,34 +448,50 @@ static bool value_equal(const Value *v1, const Value *v2) {
     case TYPE_STRING:
         return str_equal(v1->s, v2->s);
     case TYPE_LIST:
-        /* lists cannot be compared */
+    case TYPE_MAP:
+    case TYPE_STRUCT:
+        /* lists, maps and structs cannot be compared */
 
         return false;
-    case TYPE_OPTION:
-        if (v1->opt.val && v2->opt.val) {
-            return value_equal(v1->opt.val, v2->opt.val);
-        } else if (!v1->opt.val && !v2->opt.val) {
-            return true;
-        } else {
+    case TYPE_OPTION: {
+        bool present = value_opt_is_present(v1);
+
+        if (present != value_opt_is_present(v2)) {
             return false;
+        } else if (!present) {
+            return true;
         }
+
+        Value inner1 = value_opt_get(v1);
+        Value inner2 = value_opt_get(v2);
+
+        return value_equal(&inner1, &inner2);
+    }
     }
 
     return true;
 }
 
-static void new_value(Interpreter *self, Value *val, Type *type, Scope *scope) {
-    UNUSED(self);
-
+/* The value gets a new object, which belongs to the caller */
+static void new_value(Value *val, Type *type) {
     memset(val, 0, sizeof(*val));
     val->type = type;
-    val->scope = scope;
 
-    if (type->id == TYPE_LIST) {
-        Vector *values = scope_new_list(scope);
-        val->list.values = values;
+    if (type->id == TYPE_OPTION) {
+        val->type = type->opt_type.empty;
+    } else if (type->id == TYPE_LIST) {
+        val->list.values = value_new_list(type);
+    } else if (type->id == TYPE_MAP) {
+        val->map = value_new_map(type);
+    } else if (type->id == TYPE_STRUCT) {
+        const StructField *fields = type->struct_type.fields.data;
+        val->fields = value_new_struct(type);
+
+        for (size_t i = 0; i < value_struct_len(type); ++i) {
+            new_value(&val->fields[i], fields[i].type);
+        }
     } else if (type->id == TYPE_STRING) {
-        StrBuf *str = scope_new_string(scope);
+        StrBuf *str = value_new_string();
         str_init_n(str, 0);
 
         val->s = str;
@@ -340,25 +499,27 @@ static void new_value(Interpreter *self, Value *val, Type *type, Scope *scope) {
 }
 
 static Variable *new_var_shallow(
-    Interpreter *self, Type *type, const char *name, const Value *val
+    Interpreter *self, Type *type, Symbol name, const Value *val
 ) {
     UNUSED(self);
 
     Variable *var = mem_alloc(sizeof(*var));
 
     var->type = type;
-    var->name = cstr_dup(name);
+    var->name = name;
     var->val = *val;
     var->scope = self->env.curr_scope;
 
     return var;
 }
 
-static Value
-exec_binary_int(Interpreter *self, Token op, Value *v1, const Value *v2) {
-    Value val = {self->types->builtin_int, self->env.curr_scope, {0}};
+static Value exec_binary_int(
+    Interpreter *self, TokenKind op, SourceInfo src_info, const Value *v1,
+    const Value *v2
+) {
+    Value val = {self->types->builtin_int, {0}};
 
-    switch (op.kind) {
+    switch (op) {
     case TOKEN_PLUS:
         CASE_BINARY_INT(+, v1, v2);
     case TOKEN_MINUS:
@@ -367,7 +528,7 @@ exec_binary_int(Interpreter *self, Token op, Value *v1, const Value *v2) {
         CASE_BINARY_INT(*, v1, v2);
     case TOKEN_DIV:
         if (v2->i == 0) {
-            error(self, op.src_info, "division by zero");
+            error(self, src_info, "division by zero");
             val.type = self->types->error_type;
 
             return val;
@@ -376,7 +537,7 @@ exec_binary_int(Interpreter *self, Token op, Value *v1, const Value *v2) {
         CASE_BINARY_INT(/, v1, v2);
     case TOKEN_MOD:
         if (v2->i == 0) {
-            error(self, op.src_info, "division by zero");
+            error(self, src_info, "division by zero");
             val.type = self->types->error_type;
 
             return val;
@@ -395,10 +556,6 @@ exec_binary_int(Interpreter *self, Token op, Value *v1, const Value *v2) {
         CASE_BINARY_INT(<=, v1, v2);
     case TOKEN_GREATER_EQUAL:
         CASE_BINARY_INT(>=, v1, v2);
-    case TOKEN_AND:
-        CASE_BINARY_INT(&&, v1, v2);
-    case TOKEN_OR:
-        CASE_BINARY_INT(||, v1, v2);
     default:
         UNREACHABLE();
     }
@@ -406,14 +563,41 @@ exec_binary_int(Interpreter *self, Token op, Value *v1, const Value *v2) {
     return val;
 }
 
+/* The string of the newest temporary, which nothing else refers to, so it
+ * can be appended in place */
+static bool is_temp_string(const Interpreter *self, const Value *val) {
+    if (self->temps.len == self->temps_base) {
+        return false;
+    }
+
+    const Value *temp =
+        &((const Value *) self->temps.data)[self->temps.len - 1];
+
+    return temp->type->id == TYPE_STRING && temp->s == val->s &&
+           !value_is_shared(val) && !value_is_pinned(val);
+}
+
+/* temp is true if v1 is a temporary which can be modified */
 static Value exec_binary_string(
-    Interpreter *self, TokenKind op, Value *v1, const Value *v2
+    Interpreter *self, TokenKind op, const Value *v1, const Value *v2,
+    bool temp
 ) {
     Value val = *v1;
 
     switch (op) {
     case TOKEN_PLUS:
         val.type = self->types->builtin_string;
+
+        /* a chain of + appends to the string made by the first one */
+        if (!temp) {
+            val.s = value_new_string();
+            str_init_n(val.s, 0);
+            str_reserve(val.s, str_len(v1->s) + str_len(v2->s));
+            str_cat(val.s, v1->s);
+
+            add_temp(self, &val);
+        }
+
         str_cat(val.s, v2->s);
 
         break;
@@ -444,15 +628,9 @@ static Value exec_binary_option(
         val.type = self->types->builtin_int;
 
         if (v2->type->id == TYPE_NIL) {
-            val.i = v1->opt.val == NULL;
+            val.i = !value_opt_is_present(v1);
         } else if (type_equal(v1->type, v2->type)) {
-            if (v1->opt.val && v2->opt.val) {
-                val.i = value_equal(v1->opt.val, v2->opt.val);
-            } else if (!v1->opt.val && !v2->opt.val) {
-                val.i = 1;
-            } else {
-                val.i = 0;
-            }
+            val.i = value_equal(v1, v2);
         }
 
         break;
@@ -460,15 +638,9 @@ static Value exec_binary_option(
         val.type = self->types->builtin_int;
 
         if (v2->type->id == TYPE_NIL) {
-            val.i = v1->opt.val != NULL;
+            val.i = value_opt_is_present(v1);
         } else if (type_equal(v1->type, v2->type)) {
-            if (v1->opt.val && v2->opt.val) {
-                val.i = value_equal(v1->opt.val, v2->opt.val);
-            } else if (!v1->opt.val && !v2->opt.val) {
-                val.i = 0;
-            } else {
-                val.i = 1;
-            }
+            val.i = !value_equal(v1, v2);
         }
 
         break;
@@ -492,7 +664,7 @@ static Value exec_binary_nil(
         if (v2->type->id == TYPE_NIL) {
             val.i = 1;
         } else if (v2->type->id == TYPE_OPTION) {
-            val.i = v2->opt.val == NULL;
+            val.i = !value_opt_is_present(v2);
         }
 
         break;
@@ -502,7 +674,7 @@ static Value exec_binary_nil(
         if (v2->type->id == TYPE_NIL) {
             val.i = 0;
         } else if (v2->type->id == TYPE_OPTION) {
-            val.i = v2->opt.val != NULL;
+            val.i = value_opt_is_present(v2);
         }
 
         break;
@@ -513,22 +685,103 @@ static Value exec_binary_nil(
     return val;
 }
 
-static Value
-exec_binary_list(Interpreter *self, Token op, Value *v1, const Value *v2) {
+/* Every field of the new elements is an empty value of its type */
+static void
+resize_inline_list(Vector *values, Type *struct_type, size_t size) {
+    const StructField *fields = struct_type->struct_type.fields.data;
+    size_t len = value_struct_len(struct_type);
+
+    while (values->len < size) {
+        Value *elem = vec_emplace(values);
+
+        for (size_t i = 0; i < len; ++i) {
+            new_value(&elem[i], fields[i].type);
+        }
+    }
+
+    while (values->len > size) {
+        Value *elem = &((Value *) values->data)[(values->len - 1) * len];
+
+        for (size_t i = 0; i < len; ++i) {
+            value_release(&elem[i]);
+        }
+
+        vec_pop(values);
+    }
+}
+
+/* New elements are empty values of the element type */
+static void resize_list(Vector *values, Type *list_type, size_t size) {
+    Type *inner_type = list_type->list_type.type;
+
+    if (value_list_is_unboxed(list_type)) {
+        Int *ints = values->data;
+
+        /* elements past the length must stay zeroed, as growing exposes
+         * them */
+        if (size < values->len) {
+            memset(&ints[size], 0, (values->len - size) * sizeof(Int));
+        }
+
+        vec_reserve(values, size);
+        values->len = size;
+
+        return;
+    }
+
+    if (value_list_is_inline(list_type)) {
+        resize_inline_list(values, inner_type, size);
+
+        return;
+    }
+
+    while (values->len < size) {
+        Value *elem = vec_emplace(values);
+        new_value(elem, inner_type);
+    }
+
+    while (values->len > size) {
+        value_release(&VEC_LAST(values, Value));
+        vec_pop(values);
+    }
+}
+
+static Value exec_binary_list(
+    Interpreter *self, TokenKind op, SourceInfo src_info, const Value *v1,
+    const Value *v2
+) {
     Value val = *v1;
     Type *inner_type = v1->type->list_type.type;
     val.type = inner_type;
 
     Vector *values = v1->list.values;
 
-    switch (op.kind) {
+    switch (op) {
     case TOKEN_ADD_ASSIGN: {
         assert(type_equal(inner_type, v2->type));
 
+        if (value_list_is_unboxed(v1->type)) {
+            vec_push(values, &v2->i);
+
+            break;
+        }
+
+        if (value_list_is_inline(v1->type)) {
+            Value *elem = vec_emplace(values);
+
+            for (size_t i = 0; i < value_struct_len(inner_type); ++i) {
+                const Value *field = &v2->fields[i];
+
+                clone_value(self, &elem[i], field->type, field);
+            }
+
+            break;
+        }
+
         Value *elem = vec_emplace(values);
         elem->type = inner_type;
 
-        implicitly_clone_value(self, elem, v2, v1->scope);
+        implicitly_clone_value(self, elem, v2);
 
         break;
     }
@@ -536,21 +789,23 @@ exec_binary_list(Interpreter *self, Token op, Value *v1, const Value *v2) {
         assert(type_equal(self->types->builtin_int, v2->type));
 
         if (v2->i < 0) {
-            error(self, op.src_info, "the right side cannot be negative");
+            error(self, src_info, "the right side cannot be negative");
             val.type = self->types->error_type;
 
             break;
         }
 
         if (values->len == 0) {
-            error(self, op.src_info, "cannot pop more on empty list");
+            error(self, src_info, "cannot pop more on empty list");
             val.type = self->types->error_type;
 
             break;
         }
 
-        for (Int i = 0; i < v2->i; ++i) {
-            vec_pop(values);
+        if ((size_t) v2->i >= values->len) {
+            resize_list(values, v1->type, 0);
+        } else {
+            resize_list(values, v1->type, values->len - (size_t) v2->i);
         }
 
         break;
@@ -558,26 +813,13 @@ exec_binary_list(Interpreter *self, Token op, Value *v1, const Value *v2) {
         assert(type_equal(self->types->builtin_int, v2->type));
 
         if (v2->i < 0) {
-            error(self, op.src_info, "the right side cannot be negative");
+            error(self, src_info, "the right side cannot be negative");
             val.type = self->types->error_type;
 
             break;
         }
 
-        size_t size = (size_t) v2->i;
-
-        if (size > values->len) {
-            while (values->len != size) {
-                Value *elem = vec_emplace(val.list.values);
-                new_value(
-                    self, elem, inner_type, self->env.curr_scope
-                );
-            }
-        } else if (size < values->len) {
-            while (values->len != size) {
-                vec_pop(values);
-            }
-        }
+        resize_list(values, v1->type, (size_t) v2->i);
 
         break;
     }
@@ -588,11 +830,31 @@ exec_binary_list(Interpreter *self, Token op, Value *v1, const Value *v2) {
     return val;
 }
 
-static ExprResult
-exec_expr(Interpreter *self, const AstNode *node, bool assigning);
+static ExprResult *stack_push(Interpreter *self) {
+    return vec_emplace(&self->stack);
+}
+
+static ExprResult *stack_peek(Interpreter *self, size_t distance) {
+    ExprResult *stack = self->stack.data;
+
+    return &stack[self->stack.len - 1 - distance];
+}
+
+static ExprResult stack_pop(Interpreter *self) {
+    ExprResult *stack = self->stack.data;
+
+    return stack[--self->stack.len];
+}
+
+static void push_value(Interpreter *self, Value val) {
+    ExprResult *expr_res = stack_push(self);
+
+    expr_res->kind = EXPR_VALUE;
+    expr_res->val = val;
+}
 
 static Value exec_unary_int(Interpreter *self, TokenKind op, const Value *v1) {
-    Value val = {self->types->builtin_int, self->env.curr_scope, {0}};
+    Value val = {self->types->builtin_int, {0}};
 
     switch (op) {
     case TOKEN_INC:
@@ -612,14 +874,15 @@ static Value exec_unary_int(Interpreter *self, TokenKind op, const Value *v1) {
 
         break;
     case TOKEN_DOLAR: {
-        StrBuf *str = scope_new_string(self->env.curr_scope);
+        StrBuf *str = value_new_string();
 
         size_t len = (size_t) snprintf(NULL, 0, "%" PRId64, v1->i);
         str_init_n(str, len);
-        snprintf(str->data, len + 1, "%" PRId64, v1->i);
+        snprintf(str_data(str), len + 1, "%" PRId64, v1->i);
 
         val.type = self->types->builtin_string;
         val.s = str;
+        add_temp(self, &val);
 
         break;
     }
@@ -632,12 +895,12 @@ static Value exec_unary_int(Interpreter *self, TokenKind op, const Value *v1) {
 
 static Value
 exec_unary_string(Interpreter *self, TokenKind op, const Value *v1) {
-    Value val = {self->types->builtin_string, self->env.curr_scope, {0}};
+    Value val = {self->types->builtin_string, {0}};
 
     switch (op) {
     case TOKEN_HASHTAG:
         val.type = self->types->builtin_int;
-        val.i = (Int) v1->s->len;
+        val.i = (Int) str_len(v1->s);
 
         break;
     default:
@@ -648,7 +911,7 @@ exec_unary_string(Interpreter *self, TokenKind op, const Value *v1) {
 }
 
 static Value exec_unary_list(Interpreter *self, TokenKind op, const Value *v1) {
-    Value val = {self->types->error_type, self->env.curr_scope, {0}};
+    Value val = {self->types->error_type, {0}};
 
     switch (op) {
     case TOKEN_HASHTAG:
@@ -663,17 +926,13 @@ static Value exec_unary_list(Interpreter *self, TokenKind op, const Value *v1) {
     return val;
 }
 
-static Value *exec_unary_option(Interpreter *self, Token op, const Value *v1) {
-    Value *val = NULL;
+static Value exec_unary_map(Interpreter *self, TokenKind op, const Value *v1) {
+    Value val = {self->types->error_type, {0}};
 
-    switch (op.kind) {
-    case TOKEN_MUL:
-        if (v1->opt.val) {
-            val = v1->opt.val;
-        } else {
-            val = NULL;
-            error(self, op.src_info, "tried to dereference an empty option");
-        }
+    switch (op) {
+    case TOKEN_HASHTAG:
+        val.type = self->types->builtin_int;
+        val.i = (Int) v1->map->entries.len;
 
         break;
     default:
@@ -683,79 +942,133 @@ static Value *exec_unary_option(Interpreter *self, Token op, const Value *v1) {
     return val;
 }
 
-static ExprResult exec_unary(Interpreter *self, const AstNode *node) {
-    ExprResult expr = exec_expr(self, node->unary.right, false);
-    EXPR_RETURN_ON_HALT(expr.node);
+/* The result refers to the inner value, so that it can be assigned */
+static bool exec_unary_option(
+    Interpreter *self, TokenKind op, SourceInfo src_info, ExprResult *expr
+) {
+    Value opt = expr_get_value(self, expr);
 
-    Value expr_val = expr_get_value(self, &expr);
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    Value new_val = {0};
+    switch (op) {
+    case TOKEN_MUL:
+        if (!value_opt_is_present(&opt)) {
+            error(self, src_info, "tried to dereference an empty option");
+
+            return false;
+        }
+
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    if (value_opt_is_boxed(opt.type)) {
+        expr->kind = EXPR_REF;
+        expr->ref = opt.opt.val;
+        expr->ref_list = NULL;
+
+        return true;
+    }
+
+    switch (expr->kind) {
+    case EXPR_VAR:
+        expr->kind = EXPR_OPT_REF;
+        expr->opt_ref = var_value(expr->var);
+
+        break;
+    case EXPR_REF:
+        expr->kind = EXPR_OPT_REF;
+        expr->opt_ref = expr->ref;
+
+        break;
+    case EXPR_MAP_SLOT: {
+        /* the key is present, as the option is */
+        Value key = map_slot_key(expr);
+
+        expr->kind = EXPR_OPT_REF;
+        expr->opt_ref = &value_map_find(expr->map_slot.map, &key)->val;
+
+        break;
+    }
+    default:
+        /* the temporary option keeps the inner value alive */
+        expr->kind = EXPR_VALUE;
+        expr->val = value_opt_get(&opt);
+
+        break;
+    }
+
+    return true;
+}
+
+/* Increments and decrements write the result back to the variable or the
+ * element */
+static bool store_int(ExprResult *expr, Int i) {
+    switch (expr->kind) {
+    case EXPR_VAR:
+        expr->var->val.i = i;
+
+        return true;
+    case EXPR_REF:
+        expr->ref->i = i;
+
+        return true;
+    case EXPR_INT_REF:
+        *expr->int_ref = i;
+
+        return true;
+    case EXPR_CHAR_REF:
+        *expr->char_ref = (char) i;
+
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool exec_unary(Interpreter *self, TokenKind op, SourceInfo src_info) {
+    ExprResult *expr = stack_peek(self, 0);
+    Value expr_val = expr_get_value(self, expr);
+    ExprResult expr_res = {EXPR_VALUE, {0}};
 
     switch (expr_val.type->id) {
     case TYPE_INT:
-        new_val = exec_unary_int(self, node->unary.op.kind, &expr_val);
-        expr_set_value(&expr_res, &new_val);
+        expr_res.val = exec_unary_int(self, op, &expr_val);
 
         break;
     case TYPE_STRING:
-        new_val = exec_unary_string(self, node->unary.op.kind, &expr_val);
-        expr_set_value(&expr_res, &new_val);
+        expr_res.val = exec_unary_string(self, op, &expr_val);
 
         break;
     case TYPE_LIST:
-        new_val = exec_unary_list(self, node->unary.op.kind, &expr_val);
-        expr_set_value(&expr_res, &new_val);
+        expr_res.val = exec_unary_list(self, op, &expr_val);
+
+        break;
+    case TYPE_MAP:
+        expr_res.val = exec_unary_map(self, op, &expr_val);
 
         break;
     case TYPE_OPTION:
     case TYPE_NIL: {
-        Value *inner_val = exec_unary_option(self, node->unary.op, &expr_val);
-
-        if (!inner_val) {
-            expr_res.kind = EXPR_ERROR;
-
-            return expr_res;
-        } else {
-            expr_res.kind = EXPR_REF;
-            expr_res.ref = inner_val;
-        }
-
-        return expr_res;
+        return exec_unary_option(self, op, src_info, expr);
     }
     default:
-        break;
+        UNREACHABLE();
     }
 
-    if (expr_res.val.type->id == TYPE_ERROR) {
-        expr_res.kind = EXPR_ERROR;
-    } else if (expr.kind == EXPR_VAR && (node->unary.op.kind == TOKEN_INC ||
-                                         node->unary.op.kind == TOKEN_DEC)) {
-        Value temp = expr_res.val;
-
-        expr_res.kind = EXPR_VAR;
-        expr_res.var = expr.var;
-        expr_res.var->val = temp;
-    } else {
-        expr_res.kind = EXPR_VALUE;
+    if (op != TOKEN_INC && op != TOKEN_DEC) {
+        *expr = expr_res;
+    } else if (!store_int(expr, expr_res.val.i)) {
+        *expr = expr_res;
     }
 
-    return expr_res;
+    return true;
 }
 
 static ExprResult
 assign_var(Interpreter *self, Variable *var, ExprResult expr) {
-    UNUSED(self);
-
     Value rval = expr_get_value(self, &expr);
     ExprResult expr_res = {0};
 
-    Value *val = &var->val;
-    bool in_different_scope = var->scope != self->env.curr_scope;
-
-    if (in_different_scope) {
-        val = scope_new_value(var->scope, var->type);
-    }
-
     switch (expr.kind) {
     case EXPR_HALT:
         expr_res.kind = EXPR_HALT;
@@ -765,40 +1078,142 @@ assign_var(Interpreter *self, Variable *var, ExprResult expr) {
         expr_res.kind = EXPR_ERROR;
 
         return expr_res;
-    case EXPR_VALUE:
-        if (in_different_scope) {
-            implicitly_clone_value(self, val, &rval, var->scope);
-        } else {
-            shallowly_implicitly_clone_value(self, val, &rval, var->scope);
-        }
-
-        break;
-    case EXPR_VAR:
-    case EXPR_REF:
-    case EXPR_CHAR_REF:
-        implicitly_clone_value(self, val, &rval, var->scope);
-
+    default:
         break;
     }
 
-    if (in_different_scope) {
-        var->val = *val;
+    /* The variable takes a reference of its own, so that temporaries can be
+     * released. The old value is released after that, as it may be the same
+     * object. */
+    Value val = {var->type, {0}};
+    implicitly_clone_value(self, &val, &rval);
+
+    if (!var->is_borrowed) {
+        value_release(&var->val);
     }
 
+    var->val = val;
+    var->is_borrowed = false;
+    var->alias = NULL;
+    var->alias_list = NULL;
+
     expr_res.kind = EXPR_VALUE;
     expr_res.val = var->val;
 
     return expr_res;
 }
 
+/* References point into lists and options, which hold the old and the new
+ * object of the value */
 static ExprResult assign_ref(Interpreter *self, Value *val, ExprResult expr) {
     ExprResult expr_res = {0};
     Value expr_val = expr_get_value(self, &expr);
 
-    implicitly_clone_value(self, val, &expr_val, val->scope);
+    Value new_val = {val->type, {0}};
+    implicitly_clone_value(self, &new_val, &expr_val);
+
+    value_release(val);
+    *val = new_val;
 
     expr_res.kind = EXPR_REF;
     expr_res.ref = val;
+    expr_res.ref_list = NULL;
+
+    return expr_res;
+}
+
+/* The option owns the inner value, which is replaced in place */
+static ExprResult
+assign_opt_ref(Interpreter *self, Value *opt, ExprResult expr) {
+    ExprResult expr_res = {0};
+    Value expr_val = expr_get_value(self, &expr);
+    Value old_val = value_opt_get(opt);
+
+    Value new_val = {old_val.type, {0}};
+    implicitly_clone_value(self, &new_val, &expr_val);
+
+    value_release(&old_val);
+    set_opt_payload(opt, &new_val);
+
+    expr_res.kind = EXPR_OPT_REF;
+    expr_res.opt_ref = opt;
+
+    return expr_res;
+}
+
+/* Assigning nil removes the key, other values add or replace it */
+static ExprResult
+assign_map_slot(Interpreter *self, const ExprResult *slot, ExprResult expr) {
+    ExprResult expr_res = {0};
+    ValueMap *map = slot->map_slot.map;
+    Value key = map_slot_key(slot);
+    MapEntry *entry = value_map_find(map, &key);
+    Value expr_val = expr_get_value(self, &expr);
+
+    Type *type = type_system_option(self->types, map->type->map_type.value);
+    Value new_val = {type, {0}};
+    implicitly_clone_value(self, &new_val, &expr_val);
+
+    if (!value_opt_is_present(&new_val)) {
+        if (entry) {
+            value_map_remove(map, entry);
+        }
+
+        expr_res.kind = EXPR_VALUE;
+        expr_res.val = new_val;
+
+        return expr_res;
+    }
+
+    if (entry) {
+        value_release(&entry->val);
+    } else {
+        Value new_key = {key.type, {0}};
+        clone_value(self, &new_key, key.type, &key);
+
+        entry = value_map_add(map, &new_key);
+    }
+
+    entry->val = new_val;
+
+    expr_res.kind = EXPR_REF;
+    expr_res.ref = &entry->val;
+    expr_res.ref_list = NULL;
+
+    return expr_res;
+}
+
+/* Fields of the element are replaced one by one, as they're stored in the
+ * list */
+static ExprResult
+assign_struct_ref(Interpreter *self, const ExprResult *ref, ExprResult expr) {
+    Value *fields = ref->struct_ref.fields;
+    Value expr_val = expr_get_value(self, &expr);
+
+    assert(type_equal(expr_val.type, ref->struct_ref.type));
+
+    for (size_t i = 0; i < value_struct_len(expr_val.type); ++i) {
+        Value field = {fields[i].type, {0}};
+        clone_value(self, &field, fields[i].type, &expr_val.fields[i]);
+
+        value_release(&fields[i]);
+        fields[i] = field;
+    }
+
+    return *ref;
+}
+
+static ExprResult
+assign_int_ref(Interpreter *self, Int *dest, ExprResult expr) {
+    ExprResult expr_res = {0};
+    Value expr_val = expr_get_value(self, &expr);
+
+    assert(type_equal(expr_val.type, self->types->builtin_int));
+
+    *dest = expr_val.i;
+
+    expr_res.kind = EXPR_INT_REF;
+    expr_res.int_ref = dest;
 
     return expr_res;
 }
@@ -820,174 +1235,164 @@ assign_char_ref(Interpreter *self, char *dest, ExprResult expr) {
     return expr_res;
 }
 
-static ExprResult
-assign_expr(Interpreter *self, ExprResult expr1, ExprResult expr2) {
-    switch (expr1.kind) {
+static bool exec_assign(Interpreter *self, SourceInfo src_info) {
+    ExprResult expr2 = stack_pop(self);
+    ExprResult *expr1 = stack_peek(self, 0);
+
+    switch (expr1->kind) {
     case EXPR_VAR:
-        return assign_var(self, expr1.var, expr2);
+        *expr1 = assign_var(self, expr1->var, expr2);
+
+        break;
     case EXPR_REF:
-        return assign_ref(self, expr1.ref, expr2);
+        *expr1 = assign_ref(self, expr1->ref, expr2);
+
+        break;
     case EXPR_CHAR_REF:
-        return assign_char_ref(self, expr1.char_ref, expr2);
-    default:
+        *expr1 = assign_char_ref(self, expr1->char_ref, expr2);
+
         break;
-    }
+    case EXPR_INT_REF:
+        *expr1 = assign_int_ref(self, expr1->int_ref, expr2);
 
-    ExprResult expr_res;
-    expr_res.kind = EXPR_ERROR;
+        break;
+    case EXPR_OPT_REF:
+        *expr1 = assign_opt_ref(self, expr1->opt_ref, expr2);
 
-    return expr_res;
-}
+        break;
+    case EXPR_MAP_SLOT:
+        *expr1 = assign_map_slot(self, expr1, expr2);
+
+        break;
+    case EXPR_STRUCT_REF:
+        *expr1 = assign_struct_ref(self, expr1, expr2);
+
+        break;
+    default:
+        error(self, src_info, "expression cannot be assigned");
 
-static bool expr_assignable(ExprResult expr) {
-    switch (expr.kind) {
-    case EXPR_ERROR:
-    case EXPR_VALUE:
-    case EXPR_HALT:
         return false;
-    case EXPR_VAR:
-    case EXPR_REF:
-    case EXPR_CHAR_REF:
-        return true;
     }
 
-    /* satisfy gcc */
-    return false;
+    return true;
 }
 
-static ExprResult exec_binary(Interpreter *self, const AstNode *node) {
-    bool assigning = node->binary.op.kind == TOKEN_ASSIGN;
-
-    ExprResult expr1 = exec_expr(self, node->binary.left, assigning);
-    EXPR_RETURN_ON_HALT(expr1.node);
-
-    ExprResult expr2 = exec_expr(self, node->binary.right, false);
-    EXPR_RETURN_ON_HALT(expr2.node);
+static bool exec_binary(Interpreter *self, TokenKind op, SourceInfo src_info) {
+    ExprResult expr2 = stack_pop(self);
+    ExprResult *expr1 = stack_peek(self, 0);
 
-    if (expr_assignable(expr1) && assigning) {
-        return assign_expr(self, expr1, expr2);
+    /* these modify the list in place */
+    if (op == TOKEN_ADD_ASSIGN || op == TOKEN_SUB_ASSIGN ||
+        op == TOKEN_HASHTAG_ASSIGN) {
+        make_unique(self, expr1);
     }
 
-    Value v1 = expr_get_value(self, &expr1);
+    Value v1 = expr_get_value(self, expr1);
     const Value v2 = expr_get_value(self, &expr2);
 
-    ExprResult expr;
+    ExprResultKind kind = expr1->kind;
+    expr1->kind = EXPR_VALUE;
 
     switch (v1.type->id) {
     case TYPE_INT:
-        expr.kind = EXPR_VALUE;
-        expr.val = exec_binary_int(self, node->binary.op, &v1, &v2);
+        expr1->val = exec_binary_int(self, op, src_info, &v1, &v2);
 
         break;
     case TYPE_STRING:
-        expr.kind = EXPR_VALUE;
-        expr.val = exec_binary_string(self, node->binary.op.kind, &v1, &v2);
+        expr1->val = exec_binary_string(
+            self, op, &v1, &v2,
+            kind == EXPR_VALUE && is_temp_string(self, &v1)
+        );
 
         break;
     case TYPE_NIL:
-        expr.kind = EXPR_VALUE;
-        expr.val = exec_binary_nil(self, node->binary.op.kind, &v1, &v2);
+        expr1->val = exec_binary_nil(self, op, &v1, &v2);
 
         break;
     case TYPE_OPTION:
-        expr.kind = EXPR_VALUE;
-        expr.val = exec_binary_option(self, node->binary.op.kind, &v1, &v2);
+        expr1->val = exec_binary_option(self, op, &v1, &v2);
 
         break;
     case TYPE_LIST:
-        expr.kind = EXPR_VALUE;
-        expr.val = exec_binary_list(self, node->binary.op, &v1, &v2);
+        expr1->val = exec_binary_list(self, op, src_info, &v1, &v2);
 
         break;
     default:
         UNREACHABLE();
     }
 
-    return expr;
+    return !self->halt;
 }
 
-static ExprResult
-exec_suffix_int(Interpreter *self, Variable *var, const AstNode *node) {
-    Value val = {self->types->builtin_int, self->env.curr_scope, {0}};
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-
-    switch (node->unary.op.kind) {
-    case TOKEN_INC: {
-        Int old = var->val.i;
-        ++var->val.i;
+/*
+ * s = s + e. The string of the variable is appended in place if nothing else
+ * refers to it, so that building a string in a loop isn't quadratic.
+ * Otherwise it's an ordinary assignment of the concatenation.
+ */
+static void exec_append(Interpreter *self) {
+    ExprResult expr2 = stack_pop(self);
+    ExprResult *expr1 = stack_peek(self, 0);
+    Variable *var = expr1->var;
+    const Value v2 = expr_get_value(self, &expr2);
 
-        val.i = old;
+    assert(expr1->kind == EXPR_VAR);
 
-        break;
-    }
-    case TOKEN_DEC: {
-        Int old = var->val.i;
-        --var->val.i;
+    if (!var->is_borrowed && !value_is_shared(&var->val) &&
+        !value_is_pinned(&var->val)) {
+        str_cat(var->val.s, v2.s);
 
-        val.i = old;
+        expr1->kind = EXPR_VALUE;
+        expr1->val = var->val;
 
-        break;
-    }
-    default:
-        UNREACHABLE();
+        return;
     }
 
-    expr_res.val = val;
+    ExprResult sum = {EXPR_VALUE, {0}};
+    sum.val = exec_binary_string(self, TOKEN_PLUS, &var->val, &v2, false);
 
-    return expr_res;
+    *expr1 = assign_var(self, var, sum);
 }
 
-static ExprResult exec_suffix(Interpreter *self, const AstNode *node) {
-    ExprResult expr = exec_expr(self, node->suffix.left, false);
-    EXPR_RETURN_ON_HALT(expr.node);
+/* The operand stays a reference to the variable or the element */
+static void exec_suffix(Interpreter *self, TokenKind op) {
+    ExprResult *expr = stack_peek(self, 0);
+    Value old = expr_get_value(self, expr);
 
-    assert(expr.kind == EXPR_VAR);
-    Variable *var = expr.var;
+    assert(old.type->id == TYPE_INT);
 
-    switch (var->type->id) {
-    case TYPE_INT:
-        return exec_suffix_int(self, var, node);
-    default:
-        UNREACHABLE();
-
-        break;
-    }
+    Value val = exec_unary_int(self, op, &old);
+    store_int(expr, val.i);
 
-    return expr;
+    expr->kind = EXPR_VALUE;
+    expr->val = old;
 }
 
-static ExprResult exec_string_literal(Interpreter *self, const AstNode *node) {
-    ExprResult expr_res;
+/* Literals aren't copied: the value refers to the constant pool directly */
+static void exec_string_literal(Interpreter *self, StrBuf *literal) {
+    Value val = {self->types->builtin_string, {0}};
+    val.s = literal;
 
-    expr_res.kind = EXPR_VALUE;
-
-    StrBuf *str = scope_new_string(self->env.curr_scope);
-    str_dup_n(str, node->literal.str.data, node->literal.str.len);
-
-    expr_res.val.type = self->types->builtin_string;
-    expr_res.val.scope = self->env.curr_scope;
-    expr_res.val.s = str;
-
-    return expr_res;
+    push_value(self, val);
 }
 
-static ExprResult
-exec_identifier(Interpreter *self, const AstNode *node, SourceInfo src_info) {
-    ExprResult expr_res;
-
-    Variable *var = env_find_var(&self->env, node->ident.str.data);
+static bool exec_identifier(
+    Interpreter *self, const Chunk *chunk, int32_t idx, SourceInfo src_info
+) {
+    const VarRef *ref = &((const VarRef *) chunk->var_refs.data)[idx];
+    Variable *var = env_get_var(&self->env, ref->depth, ref->slot);
 
     if (!var) {
-        expr_res.kind = EXPR_ERROR;
-        error(self, src_info, "undeclared variable %s", node->ident.str.data);
+        Symbol name = ((const Symbol *) chunk->names.data)[ref->name];
+        error(self, src_info, "undeclared variable %s", name);
 
-        return expr_res;
+        return false;
     }
 
-    expr_res.kind = EXPR_VAR;
-    expr_res.var = var;
+    ExprResult *expr_res = stack_push(self);
+    expr_res->kind = EXPR_VAR;
+    expr_res->var = var;
 
-    return expr_res;
+    return true;
 }
 
 static ExprResult exec_string_subscript(
@@ -996,13 +1401,13 @@ static ExprResult exec_string_subscript(
 ) {
     ExprResult expr_res = {0};
 
-    if ((size_t) idx >= str->len) {
+    if ((size_t) idx >= str_len(str)) {
         expr_res.kind = EXPR_ERROR;
         error(
             self, src_info,
             "string index out of range: %" PRId64
             " but the string length is %zu",
-            idx, str->len
+            idx, str_len(str)
         );
 
         return expr_res;
@@ -1010,19 +1415,19 @@ static ExprResult exec_string_subscript(
 
     if (assigning) {
         expr_res.kind = EXPR_CHAR_REF;
-        expr_res.char_ref = &str->data[idx];
+        expr_res.char_ref = &str_data(str)[idx];
     } else {
         expr_res.kind = EXPR_VALUE;
         expr_res.val.type = self->types->builtin_int;
-        expr_res.val.scope = self->env.curr_scope;
-        expr_res.val.i = str->data[idx];
+        expr_res.val.i = str_data(str)[idx];
     }
 
     return expr_res;
 }
 
 static ExprResult exec_list_subscript(
-    Interpreter *self, const Value *val, Int idx, SourceInfo src_info
+    Interpreter *self, const Value *val, Int idx, SourceInfo src_info,
+    bool assigning
 ) {
     ExprResult expr_res = {0};
 
@@ -1037,656 +1442,916 @@ static ExprResult exec_list_subscript(
         return expr_res;
     }
 
+    if (value_list_is_unboxed(val->type)) {
+        Int *ints = val->list.values->data;
+
+        if (assigning) {
+            expr_res.kind = EXPR_INT_REF;
+            expr_res.int_ref = &ints[idx];
+        } else {
+            expr_res.kind = EXPR_VALUE;
+            expr_res.val.type = self->types->builtin_int;
+            expr_res.val.i = ints[idx];
+        }
+
+        return expr_res;
+    }
+
     Value *values = val->list.values->data;
 
+    if (value_list_is_inline(val->type)) {
+        Type *struct_type = val->type->list_type.type;
+
+        expr_res.kind = EXPR_STRUCT_REF;
+        expr_res.struct_ref.type = struct_type;
+        expr_res.struct_ref.fields =
+            &values[(size_t) idx * value_struct_len(struct_type)];
+
+        return expr_res;
+    }
+
     expr_res.kind = EXPR_REF;
     expr_res.ref = &values[idx];
+    expr_res.ref_list = val->list.values;
 
     return expr_res;
 }
 
-static ExprResult
-exec_subscript(Interpreter *self, const AstNode *node, bool assigning) {
-    ExprResult left_expr = exec_expr(self, node->subscript.left, false);
-    EXPR_RETURN_ON_HALT(left_expr.node);
+/*
+ * A missing key results in an empty option. The assigned element is looked
+ * up by the assignment, which may add or remove the key.
+ */
+static ExprResult exec_map_subscript(
+    Interpreter *self, const Value *val, const Value *key, bool assigning
+) {
+    ExprResult expr_res = {0};
 
-    ExprResult idx_expr = exec_expr(self, node->subscript.expr, false);
-    EXPR_RETURN_ON_HALT(idx_expr.node);
+    if (assigning) {
+        expr_res.kind = EXPR_MAP_SLOT;
+        expr_res.map_slot.map = val->map;
 
-    ExprResult expr_res = {0};
-    Value left_val = expr_get_value(self, &left_expr);
-    Value idx = expr_get_value(self, &idx_expr);
+        if (key->type->id == TYPE_STRING) {
+            /* the key outlives its variable until the statement ends */
+            value_retain(key);
+            add_temp(self, key);
 
-    switch (left_val.type->id) {
-    case TYPE_STRING:
-        return exec_string_subscript(
-            self, left_val.s, idx.i, node->tok.src_info, assigning
-        );
-    case TYPE_LIST:
-        return exec_list_subscript(self, &left_val, idx.i, node->tok.src_info);
-    default:
-        UNREACHABLE();
+            expr_res.map_slot.key.s = key->s;
+        } else {
+            expr_res.map_slot.key.i = key->i;
+        }
 
-        break;
+        return expr_res;
+    }
+
+    MapEntry *entry = value_map_find(val->map, key);
+
+    if (entry) {
+        expr_res.kind = EXPR_REF;
+        expr_res.ref = &entry->val;
+        expr_res.ref_list = NULL;
+    } else {
+        expr_res.kind = EXPR_VALUE;
+        expr_res.val = map_missing_value(self, val->map);
     }
 
     return expr_res;
 }
 
-static StmtResult exec_stmt(Interpreter *self, AstNode *node);
+/* The field is referenced in the struct, which is made unique first if the
+ * field is about to be assigned */
+static void exec_field(Interpreter *self, int32_t idx, bool assigning) {
+    ExprResult *expr = stack_peek(self, 0);
 
-static bool fill_fn_params_values(Interpreter *self, const AstNode **args) {
-    const FnParam *params = self->env.curr_fn->params.data;
+    if (assigning) {
+        make_unique(self, expr);
+    }
 
-    for (size_t i = 0; i < self->env.curr_fn->params.len; ++i) {
-        const AstNode *arg_node = args[i];
-        const FnParam *param = &params[i];
+    Value *fields = NULL;
 
-        ExprResult expr = exec_expr(self, arg_node, false);
+    if (expr->kind == EXPR_STRUCT_REF) {
+        fields = expr->struct_ref.fields;
+    } else {
+        fields = expr_get_value(self, expr).fields;
+    }
 
-        if (expr.kind == EXPR_ERROR) {
-            return false;
-        } else if (expr.kind == EXPR_HALT) {
-            break;
-        }
+    expr->kind = EXPR_REF;
+    expr->ref = &fields[idx];
+    expr->ref_list = NULL;
+}
+
+static bool
+exec_subscript(Interpreter *self, SourceInfo src_info, bool assigning) {
+    ExprResult idx_expr = stack_pop(self);
+    ExprResult *left_expr = stack_peek(self, 0);
+
+    if (assigning) {
+        make_unique(self, left_expr);
+    }
+
+    Value left_val = expr_get_value(self, left_expr);
+    Value idx = expr_get_value(self, &idx_expr);
 
-        Value arg_val = expr_get_value(self, &expr);
-        Value val = {param->type, self->env.curr_scope, {0}};
+    switch (left_val.type->id) {
+    case TYPE_STRING:
+        *left_expr = exec_string_subscript(
+            self, left_val.s, idx.i, src_info, assigning
+        );
 
-        shallowly_implicitly_clone_value(
-            self, &val, &arg_val, self->env.curr_scope
+        break;
+    case TYPE_LIST:
+        *left_expr = exec_list_subscript(
+            self, &left_val, idx.i, src_info, assigning
         );
 
-        Variable *arg = new_var_shallow(self, param->type, param->name, &val);
-        arg->is_param = true;
+        break;
+    case TYPE_MAP:
+        *left_expr = exec_map_subscript(self, &left_val, &idx, assigning);
 
-        env_add_local_var(&self->env, arg);
+        break;
+    default:
+        UNREACHABLE();
     }
 
-    return true;
+    return left_expr->kind != EXPR_ERROR;
 }
 
-static bool
-pass_args_builtin(Interpreter *self, Function *fn, const AstNode **args) {
-    vec_clear(&self->builtin_fn_args);
+/*
+ * The slice shares the buffer of the container. Short strings are copied
+ * instead, as they fit into the StrBuf of the slice anyway. Pinned containers
+ * are always copied, since a view would make them shared.
+ */
+static Value slice_value(
+    Interpreter *self, const Value *val, size_t start, size_t len
+) {
+    Value slice = {val->type, {0}};
 
-    const FnParam *params = fn->params.data;
+    if (val->type->id == TYPE_STRING) {
+        if (len > STRBUF_SSO_CAP && !value_is_pinned(val)) {
+            slice.s = value_new_string_slice(val->s, start, len);
+        } else {
+            slice.s = value_new_string();
+            str_dup_n(slice.s, str_data(val->s) + start, len);
+        }
 
-    for (size_t i = 0; i < fn->params.len; ++i) {
-        const AstNode *arg_node = args[i];
-        const FnParam *param = &params[i];
+        return slice;
+    }
 
-        ExprResult expr = exec_expr(self, arg_node, false);
+    slice.list.values = value_new_list_slice(val->list.values, start, len);
 
-        if (expr.kind == EXPR_ERROR) {
-            return false;
-        } else if (expr.kind == EXPR_HALT) {
-            break;
-        }
-
-        Value *arg = vec_emplace(&self->builtin_fn_args);
-        Value arg_val = expr_get_value(self, &expr);
-        arg->type = param->type;
+    if (value_is_pinned(val)) {
+        Value copy;
+        copy_object(self, &copy, &slice);
 
-        if (param->type->id == TYPE_OPTION && arg_val.type->id != TYPE_OPTION &&
-            type_convertable(arg_val.type, param->type)) {
-            make_opt(self, arg, param->type, &arg_val, self->env.curr_scope);
-        } else {
-            *arg = arg_val;
-        }
+        value_release(&slice);
+        slice = copy;
     }
 
-    return true;
+    return slice;
 }
 
-static ExprResult
-exec_builtin(Interpreter *self, Function *fn, const AstNode *node) {
-    ExprResult expr_res = {0};
-    Scope *saved_scope = self->env.curr_scope;
-    Scope *saved_caller = self->env.caller_scope;
-    Function *saved_fn = self->env.curr_fn;
+static bool exec_slice(Interpreter *self, SourceInfo src_info, bool to_end) {
+    ExprResult end_expr = {0};
 
-    env_enter_fn(&self->env, fn);
+    if (!to_end) {
+        end_expr = stack_pop(self);
+    }
 
-    const AstNode **arg_nodes = node->fn_call.values.data;
+    ExprResult start_expr = stack_pop(self);
+    ExprResult *left_expr = stack_peek(self, 0);
 
-    if (!pass_args_builtin(self, fn, arg_nodes)) {
-        expr_res.kind = EXPR_ERROR;
+    Value left_val = expr_get_value(self, left_expr);
+    bool is_string = left_val.type->id == TYPE_STRING;
+    size_t len = is_string ? str_len(left_val.s) : left_val.list.values->len;
 
-        goto finish;
-    }
+    Int start = expr_get_value(self, &start_expr).i;
+    Int end = to_end ? (Int) len : expr_get_value(self, &end_expr).i;
+
+    if (start < 0 || end < start || (size_t) end > len) {
+        left_expr->kind = EXPR_ERROR;
+        error(
+            self, src_info,
+            "slice out of range: [%" PRId64 ":%" PRId64 "] but the %s is %zu",
+            start, end, is_string ? "string length" : "list size", len
+        );
 
-    if (self->halt) {
-        goto finish;
+        return false;
     }
 
-    Value *args = self->builtin_fn_args.data;
+    Value slice =
+        slice_value(self, &left_val, (size_t) start, (size_t) (end - start));
+    add_temp(self, &slice);
 
-    self->env.caller_scope = saved_scope;
-    expr_res = fn->builtin(self, args, node);
+    left_expr->kind = EXPR_VALUE;
+    left_expr->val = slice;
 
-finish:
-    vec_clear(&self->builtin_fn_args);
-    env_leave_fn(&self->env);
-    self->env.curr_scope = saved_scope;
-    self->env.caller_scope = saved_caller;
-    self->env.curr_fn = saved_fn;
-
-    return expr_res;
+    return true;
 }
 
-static ExprResult
-exec_fn_body(Interpreter *self, Function *fn, const AstNode *node) {
-    ExprResult expr_res = {0};
+/*
+ * Variables and elements are passed by reference: the parameter aliases the
+ * string, list, map or struct of the argument, so it's made unique and pinned
+ * until the function returns. Modifications through either of them are then
+ * visible to both, while copies of them are real ones. Structs stored in a
+ * list are copied, since pushing to the list may move them. Options are
+ * stored inline, so they are referred to by alias_option instead.
+ */
+static Value pass_by_ref(Interpreter *self, ExprResult *arg) {
+    if (arg->kind != EXPR_VAR && arg->kind != EXPR_REF &&
+        arg->kind != EXPR_OPT_REF) {
+        return expr_get_value(self, arg);
+    }
 
-    Scope *saved_scope = self->env.curr_scope;
-    Scope *saved_caller = self->env.caller_scope;
-    Function *saved_fn = self->env.curr_fn;
+    make_unique(self, arg);
 
-    env_enter_fn(&self->env, fn);
+    Value val = expr_get_value(self, arg);
+    TypeId id = val.type->id;
 
-    const AstNode **args = node->fn_call.values.data;
+    if (id == TYPE_STRING || id == TYPE_LIST || id == TYPE_MAP ||
+        id == TYPE_STRUCT) {
+        value_pin(&val);
+        vec_push(&self->pinned, &val);
+    }
 
-    if (!fill_fn_params_values(self, args)) {
-        expr_res.kind = EXPR_ERROR;
+    return val;
+}
 
-        goto finish;
+static void unpin_args(Interpreter *self, size_t base) {
+    while (self->pinned.len > base) {
+        value_unpin(&VEC_LAST(&self->pinned, Value));
+        vec_pop(&self->pinned);
     }
+}
 
-    self->env.caller_scope = saved_scope;
-    StmtResult body_res = exec_stmt(self, fn->body);
+/*
+ * The parameter refers to the option of the argument. The list holding an
+ * element gets a pin, which keeps it alive and modified in place. Locals of
+ * the frame reused by a tail call are gone after it, so they're just copied.
+ */
+static void alias_option(
+    Interpreter *self, Variable *var, const FnParam *param, ExprResult *arg,
+    bool tail
+) {
+    Variable *arg_var = NULL;
 
-    if (self->had_error) {
-        expr_res.kind = EXPR_ERROR;
-    }
+    switch (arg->kind) {
+    case EXPR_VAR:
+        arg_var = arg->var;
 
-    if (self->halt) {
-        goto finish;
-    }
+        if (tail && !arg_var->alias && !arg_var->alias_list &&
+            arg_var->scope != self->env.global_scope) {
+            return;
+        }
 
-    switch (body_res.kind) {
-    case STMT_ERROR:
-        expr_res.kind = EXPR_ERROR;
+        if (!arg_var->alias_list) {
+            var->alias = var_value(arg_var);
 
-        break;
-    case STMT_RETURN: {
-        /* The returned value is allocated in the same scope as the caller */
-        expr_res.kind = EXPR_VALUE;
-        expr_res.val = body_res.ret_val;
+            return;
+        }
 
-        break;
-    }
-    case STMT_VOID:
-        if (fn->type->id != TYPE_VOID) {
-            expr_res.kind = EXPR_ERROR;
+        var->alias_list = arg_var->alias_list;
+        var->alias_idx = arg_var->alias_idx;
 
-            error(
-                self, expr_res.node->tok.src_info,
-                "function %s was expected to return %s, but it didn't",
-                fn->name, fn->type->name
-            );
-        } else {
-            expr_res.kind = EXPR_VALUE;
-            expr_res.val.type = self->types->builtin_void;
+        break;
+    case EXPR_REF:
+        if (!arg->ref_list || rc_is_view(arg->ref_list)) {
+            return;
         }
 
+        var->alias_list = arg->ref_list;
+        var->alias_idx = (size_t) (arg->ref - (Value *) arg->ref_list->data);
+
         break;
     default:
-        break;
+        return;
     }
 
-finish:
-    env_leave_fn(&self->env);
-    self->env.curr_scope = saved_scope;
-    self->env.caller_scope = saved_caller;
-    self->env.curr_fn = saved_fn;
+    Value list = {type_system_list(self->types, param->type), {0}};
+    list.list.values = var->alias_list;
+
+    value_pin(&list);
+    vec_push(&self->pinned, &list);
+}
+
+/*
+ * Binds the parameter to the argument. A pinned argument is borrowed, other
+ * ones are cloned. The borrowed object always gets a pin of its own, which
+ * keeps it alive even after a tail call releases the pins of the caller.
+ */
+static void bind_param(
+    Interpreter *self, Variable *var, const FnParam *param, ExprResult *arg,
+    bool tail
+) {
+    size_t pins = self->pinned.len;
+    Value arg_val = pass_by_ref(self, arg);
+
+    var->val = (Value){param->type, {0}};
+    var->is_borrowed =
+        value_is_pinned(&arg_val) && arg_val.type == param->type;
+    var->alias = NULL;
+    var->alias_list = NULL;
+
+    if (!var->is_borrowed) {
+        implicitly_clone_value(self, &var->val, &arg_val);
+
+        if (param->type->id == TYPE_OPTION &&
+            type_equal(arg_val.type, param->type)) {
+            alias_option(self, var, param, arg, tail);
+        }
 
-    return expr_res;
+        return;
+    }
+
+    if (self->pinned.len == pins) {
+        value_pin(&arg_val);
+        vec_push(&self->pinned, &arg_val);
+    }
+
+    var->val.s = arg_val.s;
+    var->val.list = arg_val.list;
 }
 
-static ExprResult exec_fn_call(Interpreter *self, const AstNode *node) {
-    const char *name = node->fn_call.name->ident.str.data;
-    Function *fn = env_find_fn(&self->env, name);
-    ExprResult expr_res = {0};
-    expr_res.node = node;
+static void fill_fn_params_values(Interpreter *self, ExprResult *args) {
+    const FnParam *params = self->env.curr_fn->params.data;
 
-    if (!fn) {
-        expr_res.kind = EXPR_ERROR;
+    for (size_t i = 0; i < self->env.curr_fn->params.len; ++i) {
+        const FnParam *param = &params[i];
 
-        return expr_res;
-    } else if (fn->is_builtin) {
-        return exec_builtin(self, fn, node);
-    } else if (!fn->body) {
-        expr_res.kind = EXPR_ERROR;
-        error(
-            self, expr_res.node->tok.src_info,
-            "function %s has no body to execute", name
+        Variable *arg = new_var_shallow(
+            self, param->type, param->name, &(Value){param->type, {0}}
         );
+        bind_param(self, arg, param, &args[i], false);
+        arg->is_param = true;
+        arg->slot = (int) i;
 
-        return expr_res;
+        env_bind_var(&self->env, arg);
     }
-
-    return exec_fn_body(self, fn, node);
 }
 
-static ExprResult exec_nil(const Interpreter *self) {
-    ExprResult expr_res = {0};
-    expr_res.kind = EXPR_VALUE;
-    expr_res.val.type = self->types->nil_type;
+static void pass_args_builtin(Interpreter *self, Function *fn, ExprResult *args) {
+    /* The buffer is overwritten entirely, so there's no need to zero it */
+    self->builtin_fn_args.len = 0;
 
-    return expr_res;
-}
+    const FnParam *params = fn->params.data;
 
-static ExprResult
-exec_expr(Interpreter *self, const AstNode *node, bool assigning) {
-    ExprResult expr_res = {0};
-    expr_res.node = node;
+    for (size_t i = 0; i < fn->params.len; ++i) {
+        const FnParam *param = &params[i];
 
-    switch (node->kind) {
-    case AST_NODE_INTEGER:
-        expr_res.kind = EXPR_VALUE;
-        expr_res.val.type = self->types->builtin_int;
-        expr_res.val.scope = self->env.curr_scope;
-        expr_res.val.i = node->literal.i;
+        Value arg = expr_get_value(self, &args[i]);
 
-        return expr_res;
-    case AST_NODE_STRING:
-        return exec_string_literal(self, node);
-    case AST_NODE_IDENT:
-        return exec_identifier(self, node, node->tok.src_info);
-    case AST_NODE_NIL:
-        return exec_nil(self);
-    case AST_NODE_UNARY:
-        return exec_unary(self, node);
-    case AST_NODE_BINARY:
-        return exec_binary(self, node);
-    case AST_NODE_SUFFIX:
-        return exec_suffix(self, node);
-    case AST_NODE_SUBSCRIPT:
-        return exec_subscript(self, node, assigning);
-    case AST_NODE_GROUPING:
-        return exec_expr(self, node->grouping.expr, assigning);
-    case AST_NODE_FN_CALL:
-        return exec_fn_call(self, node);
-    default:
-        expr_res.kind = EXPR_ERROR;
-        error(self, node->tok.src_info, "invalid expression");
+        if (param->type->id == TYPE_OPTION && arg.type->id != TYPE_OPTION &&
+            type_convertable(arg.type, param->type)) {
+            Value opt_val = {0};
+            make_opt(self, &opt_val, param->type, &arg);
+            add_temp(self, &opt_val);
+            arg = opt_val;
+        }
 
-        return expr_res;
+        vec_push(&self->builtin_fn_args, &arg);
     }
 }
 
-static Type *process_type(Interpreter *self, const AstNode *node) {
-    switch (node->kind) {
-    case AST_NODE_INT_TYPE:
-        return self->types->builtin_int;
-    case AST_NODE_STRING_TYPE:
-        return self->types->builtin_string;
-    case AST_NODE_VOID_TYPE:
-        return self->types->builtin_void;
-    case AST_NODE_LIST_TYPE: {
-        Type *contained_type = process_type(self, node->list_type.type);
-
-        Type list = {TYPE_LIST, NULL, {0}};
-        list.list_type.type = contained_type;
+/*
+ * Builtins don't get a scope of their own: arguments are passed through
+ * builtin_fn_args and results are temporaries of the caller.
+ */
+static bool exec_builtin(Interpreter *self, Function *fn) {
+    size_t argc = fn->params.len;
+    ExprResult *args = (ExprResult *) self->stack.data + self->stack.len - argc;
 
-        return type_system_register(self->types, &list);
-    }
-    case AST_NODE_OPTION_TYPE: {
-        Type *contained_type = process_type(self, node->opt_type.type);
+    pass_args_builtin(self, fn, args);
+    Value ret_val = fn->builtin(self, self->builtin_fn_args.data);
+    add_temp(self, &ret_val);
 
-        Type option = {TYPE_OPTION, NULL, {0}};
-        option.opt_type.type = contained_type;
+    self->stack.len -= argc;
+    push_value(self, ret_val);
 
-        return type_system_register(self->types, &option);
-    }
-    case AST_NODE_NIL:
-        return self->types->nil_type;
-    default:
-        return self->types->error_type;
-    }
+    return !self->halt;
 }
 
-static StmtResult exec_block(Interpreter *self, const AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
+static void enter_fn(Interpreter *self, Function *fn, CallFrame *frame) {
+    frame->scope = self->env.curr_scope;
+    frame->caller_scope = self->env.caller_scope;
+    frame->fn = self->env.curr_fn;
+    frame->scope_base = self->env.scopes.len;
+    frame->frame_base = self->env.frame_base;
+    frame->pinned_base = self->pinned.len;
+    frame->temps_base = self->temps_base;
 
-    if (node->block.nodes.len == 0) {
-        return stmt_res;
-    }
+    size_t argc = fn->params.len;
+    ExprResult *args = (ExprResult *) self->stack.data + self->stack.len - argc;
 
-    AstNode **nodes = node->block.nodes.data;
+    env_enter_fn(&self->env, fn);
+    fill_fn_params_values(self, args);
+    self->temps_base = self->temps.len;
 
-    env_enter_scope(&self->env);
+    self->env.caller_scope = frame->scope;
+    self->stack.len -= argc;
+    frame->stack_base = self->stack.len;
+}
 
-    for (size_t i = 0; i < node->block.nodes.len; ++i) {
-        StmtResult res = exec_stmt(self, nodes[i]);
+/* Returns false if the function has failed to produce a value */
+static bool
+leave_fn(Interpreter *self, const CallFrame *frame, SourceInfo src_info, bool has_value) {
+    Function *fn = self->env.curr_fn;
+    Value ret_val = {fn->type, {0}};
 
-        /* Support for break, continue and return statements */
-        if (res.kind != STMT_VOID) {
-            stmt_res = res;
+    if (has_value) {
+        ExprResult expr = stack_pop(self);
+        Value val = expr_get_value(self, &expr);
 
-            break;
-        }
+        /* Taken before the temporaries of the callee are released, as it may
+         * be one of them */
+        implicitly_clone_value(self, &ret_val, &val);
+    } else if (fn->type->id != TYPE_VOID) {
+        error(
+            self, src_info,
+            "function %s was expected to return %s, but it didn't", fn->name,
+            fn->type->name
+        );
+
+        return false;
     }
 
-    env_leave_scope(&self->env);
+    while (self->env.scopes.len > frame->scope_base + 1) {
+        env_leave_scope(&self->env);
+    }
 
-    return stmt_res;
-}
+    env_leave_fn(&self->env);
+    unpin_args(self, frame->pinned_base);
+    release_temps(self);
+    self->temps_base = frame->temps_base;
+    self->env.curr_scope = frame->scope;
+    self->env.caller_scope = frame->caller_scope;
+    self->env.curr_fn = frame->fn;
+    self->env.frame_base = frame->frame_base;
+
+    self->stack.len = frame->stack_base;
+    add_temp(self, &ret_val);
+    push_value(self, ret_val);
 
-static ExprResult exec_list_size(Interpreter *self, const AstNode *node) {
-    ExprResult expr_res = {0};
-    ExprResult size_res = exec_expr(self, node, false);
-    EXPR_RETURN_ON_HALT(node);
+    return true;
+}
 
-    Value val = expr_get_value(self, &size_res);
+static bool exec_list_size(Interpreter *self, SourceInfo src_info) {
+    ExprResult *expr = stack_peek(self, 0);
+    Value val = expr_get_value(self, expr);
     assert(val.type == self->types->builtin_int);
 
     if (val.i < 0) {
-        error(self, node->tok.src_info, "list size cannot be negative");
-        expr_res.kind = EXPR_ERROR;
+        error(self, src_info, "list size cannot be negative");
 
-        return expr_res;
+        return false;
     }
 
-    expr_res.kind = EXPR_VALUE;
-    expr_res.node = node;
-    new_value(
-        self, &expr_res.val, self->types->builtin_int, self->env.curr_scope
-    );
-    expr_res.val.i = val.i;
+    expr->kind = EXPR_VALUE;
+    new_value(&expr->val, self->types->builtin_int);
+    expr->val.i = val.i;
 
-    return expr_res;
+    return true;
 }
 
-static StmtResult exec_var_decl(Interpreter *self, const AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
-    Type *type = process_type(self, node->var_decl.type);
-    Value list_size = {0};
+static void exec_var_decl(Interpreter *self, const Chunk *chunk, int32_t idx) {
+    const VarDeclInfo *decl = &((const VarDeclInfo *) chunk->var_decls.data)[idx];
+    Symbol name = ((const Symbol *) chunk->names.data)[decl->name];
+    Type *type = decl->type;
 
-    const AstNode *size_node = node->var_decl.type->list_type.size;
-    if (type->id == TYPE_LIST && size_node) {
-        ExprResult expr = exec_list_size(self, size_node);
-        STMT_RETURN_ON_HALT(size_node);
+    ExprResult init = {0};
+    Value list_size = {0};
 
-        list_size = expr_get_value(self, &expr);
+    if (decl->has_init) {
+        init = stack_pop(self);
     }
 
-    Value val = {type, self->env.curr_scope, {0}};
+    if (decl->has_size) {
+        ExprResult size = stack_pop(self);
+        list_size = expr_get_value(self, &size);
+    }
 
-    if (node->var_decl.rvalue) {
-        ExprResult expr = exec_expr(self, node->var_decl.rvalue, false);
-        STMT_RETURN_ON_HALT(expr.node);
+    Value val = {type, {0}};
 
-        Value rval = expr_get_value(self, &expr);
+    if (decl->has_init) {
+        Value rval = expr_get_value(self, &init);
         assert(type_convertable(rval.type, type));
 
-        switch (expr.kind) {
-        case EXPR_HALT:
-            stmt_res.kind = STMT_HALT;
-
-            return stmt_res;
-        case EXPR_ERROR:
-            stmt_res.kind = STMT_ERROR;
-
-            return stmt_res;
-        case EXPR_VALUE:
-            shallowly_implicitly_clone_value(
-                self, &val, &rval, self->env.curr_scope
-            );
-
-            break;
-        case EXPR_VAR:
-        case EXPR_REF:
-        case EXPR_CHAR_REF:
-            implicitly_clone_value(self, &val, &rval, self->env.curr_scope);
-
-            break;
-        }
+        implicitly_clone_value(self, &val, &rval);
     } else {
-        new_value(self, &val, type, self->env.curr_scope);
+        new_value(&val, type);
     }
 
     /* Initialize list with empty values, if the size was given at declaration
      */
     if (type->id == TYPE_LIST && list_size.i > 0) {
-        for (Int i = 0; i < list_size.i; ++i) {
-            Value *elem = vec_emplace(val.list.values);
-            new_value(self, elem, type->list_type.type, self->env.curr_scope);
-        }
+        resize_list(val.list.values, type, (size_t) list_size.i);
     }
 
     Variable *var = mem_alloc(sizeof(*var));
-    var->name = cstr_dup(node->var_decl.name->ident.str.data);
+    var->name = name;
     var->type = type;
     var->val = val;
     var->is_param = false;
     var->scope = self->env.curr_scope;
+    var->slot = decl->slot;
+
+    env_bind_var(&self->env, var);
+}
+
+/* The keys are copied, so the map can be modified while they're visited */
+static void exec_map_keys(Interpreter *self) {
+    ExprResult *expr = stack_peek(self, 0);
+    Value map = expr_get_value(self, expr);
+    Type *key_type = map.type->map_type.key;
+    const MapEntry **entries = (const MapEntry **) map.map->entries.data;
+    size_t len = map.map->entries.len;
+
+    Value keys = {type_system_list(self->types, key_type), {0}};
+    keys.list.values = value_new_list(keys.type);
+    vec_reserve(keys.list.values, len);
+
+    for (size_t i = 0; i < len; ++i) {
+        if (value_list_is_unboxed(keys.type)) {
+            vec_push(keys.list.values, &entries[i]->key.i);
+        } else {
+            Value *key = vec_emplace(keys.list.values);
+            clone_value(self, key, key_type, &entries[i]->key);
+        }
+    }
 
-    env_add_local_var(&self->env, var);
+    add_temp(self, &keys);
 
-    return stmt_res;
+    expr->kind = EXPR_VALUE;
+    expr->val = keys;
 }
 
-static void
-create_param_list(Interpreter *self, Function *fn, const AstNode *node) {
-    const AstNode **params_nodes = node->fn_decl.params.data;
-    for (size_t i = 0; i < node->fn_decl.params.len; ++i) {
-        const AstNode *param_node = params_nodes[i];
-        Type *param_type = process_type(self, param_node->param_decl.type);
+static void exec_fn_decl(Interpreter *self, Chunk *chunk, int32_t idx) {
+    Function **fns = chunk->fns.data;
 
-        FnParam *param = vec_emplace(&fn->params);
+    /* The declaration could be executed more than once in a loop */
+    if (fns[idx]) {
+        env_add_fn(&self->env, fns[idx]);
+        fns[idx] = NULL;
+    }
+}
 
-        param->type = param_type;
-        param->name = cstr_dup(param_node->param_decl.name->ident.str.data);
+/* Look up the function once and reuse it until functions are redeclared */
+static Function *
+resolve_call_site(Interpreter *self, const Chunk *chunk, CallSite *site) {
+    if (site->epoch != self->env.fn_epoch) {
+        Symbol name = ((const Symbol *) chunk->names.data)[site->name];
+
+        site->fn = env_find_fn(&self->env, name);
+        site->epoch = self->env.fn_epoch;
     }
+
+    return site->fn;
 }
 
-static StmtResult exec_fn_decl(Interpreter *self, AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, node, {0}};
-    Type *type = process_type(self, node->fn_decl.type);
-    AstNode *body = node->fn_decl.body;
+static bool exec_fn_call(
+    Interpreter *self, int32_t idx, SourceInfo src_info, Chunk **chunk,
+    size_t *ip
+) {
+    CallSite *site = &((CallSite *) (*chunk)->call_sites.data)[idx];
+    Function *fn = resolve_call_site(self, *chunk, site);
+    Symbol name = ((const Symbol *) (*chunk)->names.data)[site->name];
+
+    if (!fn) {
+        error(self, src_info, "undeclared function %s", name);
+
+        return false;
+    } else if (fn->is_builtin) {
+        return exec_builtin(self, fn);
+    } else if (!fn->chunk) {
+        error(self, src_info, "function %s has no body to execute", name);
+
+        return false;
+    } else if (self->frames.len >= self->max_depth) {
+        error(self, src_info, "stack overflow");
 
-    if (body) {
-        /* steal ownership, so interpreter can later use the body and execute
-         * it. REPL destroys AST every time and cloning is too expensive.
-         */
-        node->fn_decl.body = NULL;
+        return false;
     }
 
-    Function *fn = mem_alloc(sizeof(*fn));
+    CallFrame *frame = vec_emplace(&self->frames);
+    frame->chunk = *chunk;
+    frame->ip = *ip;
 
-    fn->type = type;
-    fn->name = cstr_dup(node->fn_decl.name->ident.str.data);
-    fn->body = body;
-    fn->free_body = true;
-    fn->is_builtin = false;
+    enter_fn(self, fn, frame);
 
-    vec_init(&fn->params, sizeof(FnParam));
-    create_param_list(self, fn, node);
-    env_add_fn(&self->env, fn);
+    *chunk = fn->chunk;
+    *ip = 0;
 
-    return stmt_res;
+    return true;
 }
 
-static StmtResult exec_if(Interpreter *self, const AstNode *node) {
-    ExprResult cond = exec_expr(self, node->kw_if.cond, false);
-    STMT_RETURN_ON_HALT(cond.node);
+/*
+ * The current function calls itself in tail position, so its frame is reused:
+ * the parameters are rebound in place and the body starts over.
+ */
+static void exec_tail_call(Interpreter *self, size_t *ip) {
+    const CallFrame *frame = &VEC_LAST(&self->frames, CallFrame);
+    const FnParam *params = self->env.curr_fn->params.data;
+    size_t argc = self->env.curr_fn->params.len;
+    ExprResult *args = (ExprResult *) self->stack.data + self->stack.len - argc;
+    size_t pinned_mark = self->pinned.len;
+
+    /* Arguments may refer to the variables of the current call, so they're
+     * bound like in an ordinary call before the old values are released */
+    self->tail_params.len = 0;
+
+    for (size_t i = 0; i < argc; ++i) {
+        bind_param(
+            self, vec_emplace(&self->tail_params), &params[i], &args[i], true
+        );
+    }
+
+    while (self->env.scopes.len > frame->scope_base + 1) {
+        env_leave_scope(&self->env);
+    }
+
+    Scope *fn_scope = self->env.curr_scope;
+    Variable **slots = fn_scope->slots.data;
+    const Variable *new_params = self->tail_params.data;
 
-    Value cond_val = expr_get_value(self, &cond);
+    for (size_t i = 0; i < argc; ++i) {
+        Variable *var = slots[i];
 
-    if (cond_val.i) {
-        return exec_stmt(self, node->kw_if.body);
-    } else if (node->kw_if.else_body) {
-        return exec_stmt(self, node->kw_if.else_body);
+        if (!var->is_borrowed) {
+            value_release(&var->val);
+        }
+
+        var->val = new_params[i].val;
+        var->is_borrowed = new_params[i].is_borrowed;
+        var->alias = new_params[i].alias;
+        var->alias_list = new_params[i].alias_list;
+        var->alias_idx = new_params[i].alias_idx;
+    }
+
+    /* Locals declared directly in the function scope */
+    scope_truncate(fn_scope, argc);
+
+    /* Only the pins of the new arguments are kept */
+    Value *pinned = self->pinned.data;
+    size_t new_pins = self->pinned.len - pinned_mark;
+
+    for (size_t i = frame->pinned_base; i < pinned_mark; ++i) {
+        value_unpin(&pinned[i]);
     }
 
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
+    memmove(
+        &pinned[frame->pinned_base], &pinned[pinned_mark],
+        new_pins * sizeof(Value)
+    );
+    self->pinned.len = frame->pinned_base + new_pins;
+
+    release_temps(self);
+    self->stack.len = frame->stack_base;
 
-    return stmt_res;
+    *ip = 0;
 }
 
-static StmtResult exec_while(Interpreter *self, const AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
-    ExprResult cond = exec_expr(self, node->kw_while.cond, false);
-    STMT_RETURN_ON_HALT(cond.node);
+#define SRC_INFO() (((const SourceInfo *) chunk->src_infos.data)[ip - 1])
 
-    Value cond_val = expr_get_value(self, &cond);
+static void run(Interpreter *self, Chunk *chunk) {
+    size_t frames_base = self->frames.len;
+    size_t stack_base = self->stack.len;
+    size_t scope_base = self->env.scopes.len;
+    size_t pinned_base = self->pinned.len;
+    size_t saved_temps_base = self->temps_base;
+    Scope *saved_scope = self->env.curr_scope;
+    Scope *saved_caller = self->env.caller_scope;
+    Function *saved_fn = self->env.curr_fn;
+    size_t saved_frame_base = self->env.frame_base;
+
+    size_t ip = 0;
 
-    while (cond_val.i) {
-        StmtResult res = exec_stmt(self, node->kw_while.body);
+    for (;;) {
+        const Instr *instr = &((const Instr *) chunk->code.data)[ip++];
+
+        switch (instr->op) {
+        case OP_INT: {
+            Value val = {self->types->builtin_int, {0}};
+            val.i = ((const Int *) chunk->ints.data)[instr->arg];
 
-        if (self->halt) {
-            return stmt_res;
+            push_value(self, val);
+
+            break;
         }
+        case OP_STRING:
+            exec_string_literal(
+                self, ((StrBuf *const *) chunk->strings.data)[instr->arg]
+            );
+
+            break;
+        case OP_NIL: {
+            Value val = {self->types->nil_type, {0}};
+            push_value(self, val);
 
-        switch (res.kind) {
-        case STMT_VOID:
-        case STMT_CONTINUE:
             break;
-        case STMT_HALT:
-        case STMT_ERROR:
-        case STMT_RETURN:
-            return res;
-        case STMT_BREAK:
-            return stmt_res;
         }
+        case OP_GET_VAR:
+            if (!exec_identifier(self, chunk, instr->arg, SRC_INFO())) {
+                goto halt;
+            }
 
-        cond = exec_expr(self, node->kw_while.cond, false);
-        STMT_RETURN_ON_HALT(cond.node);
+            break;
+        case OP_POP:
+            --self->stack.len;
+            release_temps(self);
 
-        cond_val = expr_get_value(self, &cond);
-    }
+            break;
+        case OP_UNARY:
+            if (!exec_unary(self, (TokenKind) instr->arg, SRC_INFO())) {
+                goto halt;
+            }
 
-    return stmt_res;
-}
+            break;
+        case OP_BINARY:
+            if (!exec_binary(self, (TokenKind) instr->arg, SRC_INFO())) {
+                goto halt;
+            }
 
-static StmtResult exec_for(Interpreter *self, const AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
+            break;
+        case OP_SUFFIX:
+            exec_suffix(self, (TokenKind) instr->arg);
 
-    AstNode *init = node->kw_for.init;
-    const AstNode *cond = node->kw_for.cond;
-    const AstNode *iter = node->kw_for.iter;
-    AstNode *body = node->kw_for.body;
+            break;
+        case OP_ASSIGN:
+            if (!exec_assign(self, SRC_INFO())) {
+                goto halt;
+            }
 
-    env_enter_scope(&self->env);
+            break;
+        case OP_APPEND:
+            exec_append(self);
 
-    if (init) {
-        StmtResult stmt = exec_stmt(self, init);
-        STMT_RETURN_ON_HALT(stmt.node);
-    }
+            break;
+        case OP_SUBSCRIPT:
+            if (!exec_subscript(self, SRC_INFO(), instr->arg)) {
+                goto halt;
+            }
 
-    for (;;) {
-        if (cond) {
-            ExprResult expr = exec_expr(self, cond, false);
-            STMT_RETURN_ON_HALT(expr.node);
+            break;
+        case OP_SLICE:
+            if (!exec_slice(self, SRC_INFO(), instr->arg)) {
+                goto halt;
+            }
 
-            Value val = expr_get_value(self, &expr);
+            break;
+        case OP_FIELD:
+        case OP_FIELD_MUT:
+            exec_field(self, instr->arg, instr->op == OP_FIELD_MUT);
 
-            if (!val.i) {
-                break;
+            break;
+        case OP_CALL:
+            if (!exec_fn_call(self, instr->arg, SRC_INFO(), &chunk, &ip)) {
+                goto halt;
             }
-        }
 
-        if (body) {
-            StmtResult res = exec_stmt(self, body);
-
-            switch (res.kind) {
-            case STMT_VOID:
-            case STMT_CONTINUE:
-                break;
-            case STMT_ERROR:
-            case STMT_HALT:
-                return res;
-            case STMT_RETURN:
-                env_leave_scope(&self->env);
+            break;
+        case OP_TAIL_CALL:
+            exec_tail_call(self, &ip);
 
-                return res;
-            case STMT_BREAK:
-                env_leave_scope(&self->env);
+            break;
+        case OP_JUMP:
+            ip = (size_t) instr->arg;
 
-                return stmt_res;
+            break;
+        case OP_JUMP_IF_FALSE: {
+            ExprResult cond = stack_pop(self);
+
+            if (!expr_get_value(self, &cond).i) {
+                ip = (size_t) instr->arg;
             }
+
+            release_temps(self);
+
+            break;
         }
+        case OP_JUMP_IF_TRUE: {
+            ExprResult cond = stack_pop(self);
+
+            if (expr_get_value(self, &cond).i) {
+                ip = (size_t) instr->arg;
+            }
+
+            release_temps(self);
 
-        if (iter) {
-            ExprResult expr = exec_expr(self, iter, false);
-            STMT_RETURN_ON_HALT(expr.node);
+            break;
         }
-    }
+        case OP_AND:
+        case OP_OR: {
+            ExprResult left = stack_pop(self);
+            bool is_true = expr_get_value(self, &left).i != 0;
+
+            /* The result is decided by the left operand alone */
+            if (is_true == (instr->op == OP_OR)) {
+                Value val = {self->types->builtin_int, {0}};
+                val.i = is_true;
+
+                push_value(self, val);
+                ip = (size_t) instr->arg;
+            }
 
-    env_leave_scope(&self->env);
+            break;
+        }
+        case OP_BOOL: {
+            ExprResult *top = stack_peek(self, 0);
+            Value val = {self->types->builtin_int, {0}};
+            val.i = expr_get_value(self, top).i != 0;
 
-    return stmt_res;
-}
+            top->kind = EXPR_VALUE;
+            top->val = val;
 
-static StmtResult exec_return(Interpreter *self, const AstNode *node) {
-    StmtResult res = {0};
-    res.kind = STMT_RETURN;
+            break;
+        }
+        case OP_ENTER_SCOPE:
+            env_enter_scope(&self->env);
 
-    if (node->kw_return.expr) {
-        ExprResult expr = exec_expr(self, node->kw_return.expr, false);
-        STMT_RETURN_ON_HALT(expr.node);
+            break;
+        case OP_LEAVE_SCOPE:
+            for (int32_t i = 0; i < instr->arg; ++i) {
+                env_leave_scope(&self->env);
+            }
 
-        Value val = expr_get_value(self, &expr);
+            break;
+        case OP_LIST_SIZE:
+            if (!exec_list_size(self, SRC_INFO())) {
+                goto halt;
+            }
 
-        res.ret_val.type = self->env.curr_fn->type;
-        res.ret_val.scope = self->env.caller_scope;
+            break;
+        case OP_MAP_KEYS:
+            exec_map_keys(self);
 
-        implicitly_clone_value(
-            self, &res.ret_val, &val, self->env.caller_scope
-        );
-    } else {
-        res.ret_val.type = self->types->builtin_void;
-    }
+            break;
+        case OP_VAR_DECL:
+            exec_var_decl(self, chunk, instr->arg);
+            release_temps(self);
 
-    return res;
-}
+            break;
+        case OP_FN_DECL:
+            exec_fn_decl(self, chunk, instr->arg);
 
-static StmtResult exec_stmt(Interpreter *self, AstNode *node) {
-    StmtResult stmt_res = {STMT_VOID, .node = node, {0}};
+            break;
+        case OP_RETURN: {
+            if (self->frames.len == frames_base) {
+                goto finish;
+            }
 
-    switch (node->kind) {
-    case AST_NODE_BLOCK:
-        return exec_block(self, node);
-    case AST_NODE_VAR_DECL:
-        return exec_var_decl(self, node);
-    case AST_NODE_FN_DECL:
-        return exec_fn_decl(self, node);
-    case AST_NODE_IF:
-        return exec_if(self, node);
-    case AST_NODE_WHILE:
-        return exec_while(self, node);
-    case AST_NODE_FOR:
-        return exec_for(self, node);
-    case AST_NODE_BREAK:
-        stmt_res.kind = STMT_BREAK;
+            CallFrame frame = VEC_LAST(&self->frames, CallFrame);
+            --self->frames.len;
 
-        break;
-    case AST_NODE_CONTINUE:
-        stmt_res.kind = STMT_CONTINUE;
+            if (!leave_fn(self, &frame, SRC_INFO(), instr->arg)) {
+                goto halt;
+            }
 
-        break;
-    case AST_NODE_RETURN:
-        return exec_return(self, node);
-    default: {
-        ExprResult expr = exec_expr(self, node, false);
-        STMT_RETURN_ON_HALT(expr.node);
+            chunk = frame.chunk;
+            ip = frame.ip;
 
-        break;
+            break;
+        }
+        case OP_INVALID:
+            error(self, SRC_INFO(), "invalid expression");
+
+            goto halt;
+        case OP_END:
+            goto finish;
+        }
     }
+
+halt:
+    self->stack.len = stack_base;
+
+    while (self->env.scopes.len > scope_base) {
+        env_leave_scope(&self->env);
     }
 
-    return stmt_res;
+    self->temps_base = saved_temps_base;
+    release_temps(self);
+
+finish:
+    unpin_args(self, pinned_base);
+    self->temps_base = saved_temps_base;
+    self->frames.len = frames_base;
+    self->env.curr_scope = saved_scope;
+    self->env.caller_scope = saved_caller;
+    self->env.curr_fn = saved_fn;
+    self->env.frame_base = saved_frame_base;
 }
 
 void interp_init(Interpreter *self, Ast *ast, TypeSystem *types) {
     self->types = types;
 
     env_init(&self->env, types);
+    const_pool_init(&self->consts);
     vec_init(&self->builtin_fn_args, sizeof(Value));
+    vec_init(&self->tail_params, sizeof(Variable));
+    vec_init(&self->stack, sizeof(ExprResult));
+    vec_init(&self->frames, sizeof(CallFrame));
+    vec_init(&self->pinned, sizeof(Value));
+    vec_init(&self->temps, sizeof(Value));
 
+    self->max_depth = INTERP_DEFAULT_MAX_DEPTH;
     self->ast = ast;
+    self->temps_base = 0;
     self->exit_code = 0;
     self->halt = false;
     self->had_error = false;
@@ -1696,24 +2361,46 @@ void interp_init(Interpreter *self, Ast *ast, TypeSystem *types) {
 }
 
 void interp_deinit(Interpreter *self) {
+    self->temps_base = 0;
+    release_temps(self);
+
     env_deinit(&self->env);
+    const_pool_deinit(&self->consts);
     vec_deinit(&self->builtin_fn_args);
+    vec_deinit(&self->tail_params);
+    vec_deinit(&self->stack);
+    vec_deinit(&self->frames);
+    vec_deinit(&self->pinned);
+    vec_deinit(&self->temps);
+}
+
+int interp_run(Interpreter *self, Chunk *chunk) {
+    /* The result of the last evaluation isn't needed anymore */
+    self->temps_base = 0;
+    release_temps(self);
+
+    run(self, chunk);
+    self->stack.len = 0;
+
+    if (self->had_error) {
+        self->exit_code = -1;
+    }
+
+    return self->exit_code;
 }
 
 int interp_walk(Interpreter *self) {
-    AstNode **nodes = self->ast->nodes.data;
+    Compiler compiler;
+    compiler_init(&compiler, self->types, &self->consts);
 
-    for (size_t i = 0; i < self->ast->nodes.len; ++i) {
-        exec_stmt(self, nodes[i]);
+    Chunk chunk;
+    chunk_init(&chunk);
 
-        if (self->had_error) {
-            self->exit_code = -1;
-        }
+    compiler_compile(&compiler, self->ast, &chunk);
+    interp_run(self, &chunk);
 
-        if (self->halt) {
-            break;
-        }
-    }
+    chunk_deinit(&chunk);
+    compiler_deinit(&compiler);
 
     return self->exit_code;
 }
@@ -1727,49 +2414,66 @@ Value interp_eval(Interpreter *self) {
         return val;
     }
 
-    ExprResult expr =
-        exec_expr(self, ((const AstNode **) self->ast->nodes.data)[0], false);
+    /* The result of the last evaluation isn't needed anymore */
+    self->temps_base = 0;
+    release_temps(self);
 
-    Value expr_val = expr_get_value(self, &expr);
-    val.type = expr_val.type;
-    val = expr_val;
+    Compiler compiler;
+    compiler_init(&compiler, self->types, &self->consts);
+
+    Chunk chunk;
+    chunk_init(&chunk);
+
+    compiler_compile_expr(
+        &compiler, ((const AstNode **) self->ast->nodes.data)[0], &chunk
+    );
+    run(self, &chunk);
 
     if (self->had_error) {
         val.type = self->types->error_type;
         self->exit_code = -1;
+    } else if (self->stack.len > 0) {
+        val = expr_get_value(self, stack_peek(self, 0));
+    } else {
+        val.type = self->types->builtin_void;
     }
 
+    self->stack.len = 0;
+
+    chunk_deinit(&chunk);
+    compiler_deinit(&compiler);
+
     return val;
 }
 
-ExprResult builtin_print(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_void;
+Value builtin_print(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_void;
 
-    fputs(args[0].s->data, stdout);
+    /* slices aren't null terminated */
+    fwrite(str_data(args[0].s), 1, str_len(args[0].s), stdout);
 
-    return expr_res;
+    return val;
 }
 
-ExprResult
-builtin_println(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_void;
+Value builtin_println(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_void;
 
-    fputs(args[0].s->data, stdout);
+    fwrite(str_data(args[0].s), 1, str_len(args[0].s), stdout);
     fputc('\n', stdout);
 
-    return expr_res;
+    return val;
 }
 
-ExprResult builtin_exit(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_void;
+Value builtin_exit(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_void;
 
     self->exit_code = (int) args[0].i;
     self->halt = true;
 
-    return expr_res;
+    return val;
 }
 
 static bool fgets_wrapper(char *buf, size_t size, FILE *file) {
@@ -1788,116 +2492,96 @@ static bool fgets_wrapper(char *buf, size_t size, FILE *file) {
     return false;
 }
 
-ExprResult
-builtin_input_int(Interpreter *self, Value *args, const AstNode *node) {
+Value builtin_input_int(Interpreter *self, Value *args) {
     UNUSED(args);
 
-    Type *opt_int = type_system_get(self->types, "option<int>");
-
-    /* Type has to be registered by env_init() */
-    assert(opt_int != NULL);
+    Type *opt_int =
+        type_system_option(self->types, self->types->builtin_int);
 
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = opt_int;
+    Value ret_val;
+    new_value(&ret_val, opt_int);
 
-    Value val;
-    new_value(self, &val, self->types->builtin_int, self->env.caller_scope);
+    Value val = {self->types->builtin_int, {0}};
 
     static char temp_buf[INPUT_BUFSIZE];
 
     if (fgets_wrapper(temp_buf, sizeof(temp_buf), stdin) &&
         str_to_i64(temp_buf, &val.i)) {
-        make_opt(self, &expr_res.val, opt_int, &val, self->env.caller_scope);
-    } else {
-        expr_res.val.opt.val = NULL;
+        make_opt(self, &ret_val, opt_int, &val);
     }
 
-    return expr_res;
+    return ret_val;
 }
 
-ExprResult
-builtin_input_string(Interpreter *self, Value *args, const AstNode *node) {
+Value builtin_input_string(Interpreter *self, Value *args) {
     UNUSED(args);
 
-    Type *opt_string = type_system_get(self->types, "option<string>");
-
-    /* Type has to be registered by env_init() */
-    assert(opt_string != NULL);
+    Type *opt_string =
+        type_system_option(self->types, self->types->builtin_string);
 
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = opt_string;
-    expr_res.val.scope = self->env.caller_scope;
-    expr_res.val.opt.val = NULL;
+    Value val;
+    new_value(&val, opt_string);
 
     Value temp_val;
 
-    new_value(
-        self, &temp_val, self->types->builtin_string, self->env.caller_scope
-    );
+    new_value(&temp_val, self->types->builtin_string);
 
     static char temp_buf[INPUT_BUFSIZE];
 
     if (fgets_wrapper(temp_buf, sizeof(temp_buf), stdin)) {
         str_set_cstr(temp_val.s, temp_buf);
-        make_opt(
-            self, &expr_res.val, opt_string, &temp_val, self->env.caller_scope
-        );
+        make_opt(self, &val, opt_string, &temp_val);
     }
 
-    return expr_res;
+    value_release(&temp_val);
+
+    return val;
 }
 
-ExprResult builtin_random(Interpreter *self, Value *args, const AstNode *node) {
+Value builtin_random(Interpreter *self, Value *args) {
     UNUSED(args);
 
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_int;
-    expr_res.val.scope = self->env.caller_scope;
+    Value val = {0};
+    val.type = self->types->builtin_int;
 
-    expr_res.val.i = rand();
+    val.i = rand();
 
-    return expr_res;
+    return val;
 }
 
-ExprResult
-builtin_random_range(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_int;
-    expr_res.val.scope = self->env.caller_scope;
+Value builtin_random_range(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_int;
 
     const Value *min = &args[0];
     const Value *max = &args[1];
 
-    expr_res.val.i = rand() % ((int) max->i + 1 - (int) min->i) + (int) min->i;
+    val.i = rand() % ((int) max->i + 1 - (int) min->i) + (int) min->i;
 
-    return expr_res;
+    return val;
 }
 
-ExprResult
-builtin_chr(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_string;
-    expr_res.val.scope = self->env.caller_scope;
+Value builtin_chr(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_string;
 
     const Value *ch = &args[0];
 
-    StrBuf *str = scope_new_string(self->env.caller_scope);
+    StrBuf *str = value_new_string();
     str_init_n(str, 1);
-    str->data[0] = (char) ch->i;
+    str_data(str)[0] = (char) ch->i;
 
-    expr_res.val.s = str;
+    val.s = str;
 
-    return expr_res;
+    return val;
 }
 
-ExprResult
-builtin_ord(Interpreter *self, Value *args, const AstNode *node) {
-    ExprResult expr_res = {EXPR_VALUE, .node = node, {0}};
-    expr_res.val.type = self->types->builtin_int;
-    expr_res.val.scope = self->env.caller_scope;
+Value builtin_ord(Interpreter *self, Value *args) {
+    Value val = {0};
+    val.type = self->types->builtin_int;
 
     const Value *ch = &args[0];
-    expr_res.val.i = ch->s->data[0];
+    val.i = str_data(ch->s)[0];
 
-    return expr_res;
+    return val;
 }
@@ -33,6 +33,8 @@ static bool is_operator(char ch) {
     switch (ch) {
     case ',':
     case ';':
+    case ':':
+    case '.':
     case '(':
     case ')':
     case ']':
@@ -60,9 +62,10 @@ static bool is_operator(char ch) {
 }
 
 static TokenKind identifier_kind(const char *s, size_t len) {
-    static const char *keywords[] = {"if",     "else",  "for",      "while",
-                                     "return", "break", "continue", "nil",
-                                     "int",    "void",  "string"};
+    static const char *keywords[] = {
+        "if",  "else", "for",  "while",  "return", "break", "continue",
+        "nil", "int",  "void", "string", "map",    "struct"
+    };
 
     for (size_t i = 0; i < ARRAY_SIZE(keywords); ++i) {
         if (strlen(keywords[i]) == len && strncmp(s, keywords[i], len) == 0) {
@@ -107,6 +110,10 @@ static TokenKind single_operator_kind(char ch) {
         return TOKEN_COMMA;
     case ';':
         return TOKEN_SEMICOLON;
+    case ':':
+        return TOKEN_COLON;
+    case '.':
+        return TOKEN_DOT;
     case '(':
         return TOKEN_LPAREN;
     case ')':
@@ -343,16 +350,17 @@ void lexer_lex(const char *data, size_t len, Vector *tokens) {
 
 const char *token_kind_to_str(TokenKind kind) {
     static const char *strs[] = {
-        "unknown", "EOF",   "integer",  "identifier", "string literal",
-        ",",       ";",     "(",        ")",          "[",
-        "]",       "{",     "}",        "+",          "-",
-        "*",       "/",     "%",        "++",         "--",
-        "!",       "<",     ">",        "=",          "+=",
-        "-=",      "#=",    "==",       "!=",         "<=",
-        ">=",      "&&",    "||",       "?",          "#",
-        "$",       "if",    "else",     "for",        "while",
-        "return",  "break", "continue", "nil",        "int",
-        "void",    "string"
+        "unknown", "EOF",      "integer", "identifier", "string literal",
+        ",",       ";",        ":",       ".",          "(",
+        ")",       "[",        "]",       "{",          "}",
+        "+",       "-",        "*",       "/",          "%",
+        "++",      "--",       "!",       "<",          ">",
+        "=",       "+=",       "-=",      "#=",         "==",
+        "!=",      "<=",       ">=",      "&&",         "||",
+        "?",       "#",        "$",       "if",         "else",
+        "for",     "while",    "return",  "break",      "continue",
+        "nil",     "int",      "void",    "string",     "map",
+        "struct"
     };
 
     return strs[kind];
@@ -367,6 +375,8 @@ const char *token_kind_to_name(TokenKind kind) {
         "string literal",
         "comma",
         "semicolon",
+        "colon",
+        "dot",
         "left paren",
         "right paren",
         "left bracket",
@@ -406,7 +416,9 @@ const char *token_kind_to_name(TokenKind kind) {
         "keyword nil",
         "keyword int",
         "keyword void",
-        "keyword string"
+        "keyword string",
+        "keyword map",
+        "keyword struct"
     };
 
     return names[kind];
@@ -6,10 +6,14 @@
  */
 
 #include <monolog/cli.h>
+#include <monolog/compiler.h>
 #include <monolog/interp.h>
 #include <monolog/lexer.h>
+#include <monolog/optimizer.h>
 #include <monolog/parser.h>
+#include <monolog/rc.h>
 #include <monolog/semck.h>
+#include <monolog/symbol.h>
 #include <monolog/utils.h>
 #include <monolog/vector.h>
 
@@ -104,67 +108,153 @@ highlighter(ic_highlight_env_t *henv, const char *input, void *arg) {
     }
 }
 
-int cmd_run(int argc, char **argv) {
-    UNUSED(argc);
+static void print_stats(void) {
+    ArenaStats stats = rc_stats();
+
+    fprintf(
+        stderr,
+        "allocations: %zu (%zu bytes)\n"
+        "frees: %zu\n"
+        "chunks: %zu (%zu bytes)\n",
+        stats.allocs, stats.bytes, stats.frees, stats.chunks,
+        stats.chunks * (size_t) ARENA_CHUNK_SIZE
+    );
+}
 
-    const char *filename = argv[2];
+/* Prints semantic errors, if there are any, or optimizes the AST otherwise */
+static bool check_and_optimize(Ast *ast, TypeSystem *types) {
+    SemChecker semck;
+    semck_init(&semck, types);
+    bool ok = semck_check(&semck, ast, NULL, NULL);
+    DiagnosticMessage *dmsgs = semck.dmsgs.data;
 
-    char *input = read_file(filename);
+    for (size_t i = 0; i < semck.dmsgs.len; ++i) {
+        const DiagnosticMessage *dmsg = &dmsgs[i];
 
-    if (!input) {
-        perror("error: cannot read input file");
+        printf(
+            "%d:%d: error: %s\n", dmsg->src_info.line, dmsg->src_info.col,
+            dmsg_to_str(dmsg)
+        );
+    }
 
-        return -1;
+    semck_deinit(&semck);
+
+    if (ok) {
+        Optimizer optimizer;
+        optimizer_init(&optimizer);
+        optimizer_optimize(&optimizer, ast);
+        optimizer_deinit(&optimizer);
     }
 
+    return ok;
+}
+
+/* A source file, from its contents to the AST. The tokens are kept, since the
+ * AST refers to them. */
+typedef struct Program {
+    char *input;
     Vector tokens;
-    vec_init(&tokens, sizeof(Token));
+    Ast ast;
+    TypeSystem types;
+    bool had_error;
+} Program;
 
-    lexer_lex(input, strlen(input), &tokens);
+/*
+ * Reads and parses the file. If check is true, the AST is also checked and
+ * optimized. Returns false if the file cannot be read, syntax and semantic
+ * errors are reported by had_error.
+ */
+static bool program_load(Program *self, const char *filename, bool check) {
+    self->input = read_file(filename);
 
-    Parser parser = parser_new(tokens.data, tokens.len);
+    if (!self->input) {
+        perror("error: cannot read input file");
+
+        return false;
+    }
+
+    vec_init(&self->tokens, sizeof(Token));
+    lexer_lex(self->input, strlen(self->input), &self->tokens);
+
+    Parser parser = parser_new(self->tokens.data, self->tokens.len);
     parser.log_errors = true;
 
-    Ast ast = parser_parse(&parser);
+    self->ast = parser_parse(&parser);
+    self->had_error = parser.had_error;
 
-    TypeSystem types;
-    type_system_init(&types);
+    type_system_init(&self->types);
 
-    bool had_error = parser.had_error;
+    if (check && !self->had_error) {
+        self->had_error = !check_and_optimize(&self->ast, &self->types);
+    }
 
-    if (!had_error) {
-        SemChecker semck;
-        semck_init(&semck, &types);
-        had_error = !semck_check(&semck, &ast, NULL, NULL);
-        DiagnosticMessage *dmsgs = semck.dmsgs.data;
+    return true;
+}
 
-        for (size_t i = 0; i < semck.dmsgs.len; ++i) {
-            const DiagnosticMessage *dmsg = &dmsgs[i];
+static void program_unload(Program *self) {
+    type_system_deinit(&self->types);
+    ast_destroy(&self->ast);
+    vec_deinit(&self->tokens);
+    free(self->input);
+}
 
-            printf(
-                "%d:%d: error: %s\n", dmsg->src_info.line, dmsg->src_info.col,
-                dmsg_to_str(dmsg)
-            );
+int cmd_run(int argc, char **argv) {
+    bool stats = false;
+    size_t max_depth = INTERP_DEFAULT_MAX_DEPTH;
+    int arg = 2;
+
+    for (; arg < argc - 1; ++arg) {
+        if (strcmp(argv[arg], "--stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[arg], "--max-depth") == 0 && arg < argc - 2) {
+            char *end;
+            long long depth = strtoll(argv[++arg], &end, 10);
+
+            if (*end || depth <= 0) {
+                fprintf(stderr, "error: invalid max depth %s\n", argv[arg]);
+
+                return -1;
+            }
+
+            max_depth = (size_t) depth;
+        } else {
+            break;
         }
+    }
+
+    Program prog;
 
-        semck_deinit(&semck);
+    if (!program_load(&prog, argv[arg], true)) {
+        return -1;
     }
 
     int exit_code = -1;
 
-    if (!had_error) {
+    if (!prog.had_error) {
         Interpreter interp;
-        interp_init(&interp, &ast, &types);
+        interp_init(&interp, &prog.ast, &prog.types);
         interp.log_errors = true;
+        interp.max_depth = max_depth;
+
+        Compiler compiler;
+        compiler_init(&compiler, &prog.types, &interp.consts);
 
-        exit_code = interp_walk(&interp);
+        Chunk chunk;
+        chunk_init(&chunk);
+        compiler_compile(&compiler, &prog.ast, &chunk);
+
+        exit_code = interp_run(&interp, &chunk);
+
+        if (stats) {
+            print_stats();
+        }
+
+        chunk_deinit(&chunk);
+        compiler_deinit(&compiler);
         interp_deinit(&interp);
     }
 
-    type_system_deinit(&types);
-    ast_destroy(&ast);
-    vec_deinit(&tokens);
-    free(input);
+    program_unload(&prog);
 
     return exit_code;
 }
@@ -203,40 +293,63 @@ int cmd_scan(int argc, char **argv) {
 }
 
 int cmd_parse(int argc, char **argv) {
-    UNUSED(argc);
+    bool optimized = argc > 3 && strcmp(argv[2], "--optimized") == 0;
+    Program prog;
 
-    const char *filename = argv[2];
+    /* The optimized AST is the one that gets compiled */
+    if (!program_load(&prog, argv[optimized ? 3 : 2], optimized)) {
+        return -1;
+    }
 
-    char *input = read_file(filename);
+    bool had_error = prog.had_error;
 
-    if (!input) {
-        perror("error: cannot read input file");
+    if (!optimized || !had_error) {
+        ast_dump(&prog.ast, stdout);
+    }
 
+    program_unload(&prog);
+
+    return had_error ? -1 : 0;
+}
+
+int cmd_dis(int argc, char **argv) {
+    UNUSED(argc);
+
+    Program prog;
+
+    if (!program_load(&prog, argv[2], true)) {
         return -1;
     }
 
-    Vector tokens;
-    vec_init(&tokens, sizeof(Token));
+    bool had_error = prog.had_error;
 
-    lexer_lex(input, strlen(input), &tokens);
+    if (!had_error) {
+        ConstPool consts;
+        const_pool_init(&consts);
 
-    Parser parser = parser_new(tokens.data, tokens.len);
-    parser.log_errors = true;
+        Compiler compiler;
+        compiler_init(&compiler, &prog.types, &consts);
 
-    Ast ast = parser_parse(&parser);
-    ast_dump(&ast, stdout);
+        Chunk chunk;
+        chunk_init(&chunk);
+        compiler_compile(&compiler, &prog.ast, &chunk);
+        chunk_dump(&chunk, stdout);
 
-    ast_destroy(&ast);
-    vec_deinit(&tokens);
-    free(input);
+        chunk_deinit(&chunk);
+        compiler_deinit(&compiler);
+        const_pool_deinit(&consts);
+    }
+
+    program_unload(&prog);
 
-    return parser.had_error ? -1 : 0;
+    return had_error ? -1 : 0;
 }
 
 static void print_help(void) {
-    printf("usage: monolog run FILENAME\n"
+    printf("usage: monolog run [--stats] [--max-depth N] FILENAME\n"
            "       monolog scan FILENAME\n"
-           "       monolog parse FILENAME\n"
+           "       monolog parse [--optimized] FILENAME\n"
+           "       monolog dis FILENAME\n"
            "       monolog repl\n");
 }
 
@@ -260,6 +373,9 @@ int cmd_repl(int argc, char **argv) {
     interp_init(&interp, NULL, &types);
     interp.log_errors = true;
 
+    Compiler compiler;
+    compiler_init(&compiler, &types, &interp.consts);
+
     char *input;
     while ((input = ic_readline(""))) {
         interp.had_error = false;
@@ -293,8 +409,18 @@ int cmd_repl(int argc, char **argv) {
         }
 
         if (!had_error) {
+            Optimizer optimizer;
+            optimizer_init(&optimizer);
+            optimizer_optimize(&optimizer, &ast);
+            optimizer_deinit(&optimizer);
+
+            Chunk chunk;
+            chunk_init(&chunk);
+            compiler_compile(&compiler, &ast, &chunk);
+
             interp.ast = &ast;
-            interp_walk(&interp);
+            interp_run(&interp, &chunk);
+            chunk_deinit(&chunk);
         }
 
         ast_destroy(&ast);
@@ -306,6 +432,7 @@ int cmd_repl(int argc, char **argv) {
         }
     }
 
+    compiler_deinit(&compiler);
     interp_deinit(&interp);
     semck_deinit(&semck);
     type_system_deinit(&types);
@@ -318,6 +445,7 @@ static CliCommand g_cmds[] = {
     {.name = "run", .args = 1, .fn = cmd_run},
     {.name = "scan", .args = 1, .fn = cmd_scan},
     {.name = "parse", .args = 1, .fn = cmd_parse},
+    {.name = "dis", .args = 1, .fn = cmd_dis},
     {.name = "repl", .args = 0, .fn = cmd_repl}
 };
 
@@ -332,7 +460,11 @@ int main(int argc, char **argv) {
 
     for (size_t i = 0; i < ARRAY_SIZE(g_cmds); ++i) {
         if (strcmp(g_cmds[i].name, cmd) == 0) {
-            return g_cmds[i].fn(argc, argv);
+            int exit_code = g_cmds[i].fn(argc, argv);
+            sym_table_deinit();
+            rc_deinit();
+
+            return exit_code;
         }
     }
 
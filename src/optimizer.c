@@ -0,0 +1,846 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/optimizer.h>
+#include <monolog/type.h>
+#include <monolog/utils.h>
+#include <monolog/variable.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static AstNode *replace(Optimizer *self, AstNode *node, AstNode *lit) {
+    astnode_destroy(node);
+    ++self->folded;
+
+    return lit;
+}
+
+static AstNode *new_int(Optimizer *self, AstNode *node, int64_t i) {
+    AstNode *lit = astnode_new(AST_NODE_INTEGER, &node->tok);
+    lit->literal.i = i;
+
+    return replace(self, node, lit);
+}
+
+/* The string is initialized by the caller, since short strings are stored
+ * inline and can't be moved */
+static AstNode *new_string(const AstNode *node) {
+    return astnode_new(AST_NODE_STRING, &node->tok);
+}
+
+static bool is_int(const AstNode *node) {
+    return node->kind == AST_NODE_INTEGER;
+}
+
+static bool is_string(const AstNode *node) {
+    return node->kind == AST_NODE_STRING;
+}
+
+static AstNode *fold_expr(Optimizer *self, AstNode *node);
+
+static AstNode *fold_unary(Optimizer *self, AstNode *node) {
+    node->unary.right = fold_expr(self, node->unary.right);
+
+    const AstNode *right = node->unary.right;
+
+    switch (node->unary.op.kind) {
+    case TOKEN_PLUS:
+        return is_int(right) ? new_int(self, node, right->literal.i) : node;
+    case TOKEN_MINUS:
+        /* wraps around like the interpreter does */
+        return is_int(right)
+                   ? new_int(
+                         self, node,
+                         (int64_t) (0 - (uint64_t) right->literal.i)
+                     )
+                   : node;
+    case TOKEN_EXCL:
+        return is_int(right) ? new_int(self, node, !right->literal.i) : node;
+    case TOKEN_HASHTAG:
+        return is_string(right)
+                   ? new_int(self, node, (int64_t) str_len(&right->literal.str))
+                   : node;
+    case TOKEN_DOLAR: {
+        if (!is_int(right)) {
+            return node;
+        }
+
+        AstNode *lit = new_string(node);
+        StrBuf *str = &lit->literal.str;
+
+        size_t len = (size_t) snprintf(NULL, 0, "%" PRId64, right->literal.i);
+        str_init_n(str, len);
+        snprintf(str_data(str), len + 1, "%" PRId64, right->literal.i);
+
+        return replace(self, node, lit);
+    }
+    default:
+        return node;
+    }
+}
+
+static AstNode *fold_int_binary(Optimizer *self, AstNode *node) {
+    int64_t a = node->binary.left->literal.i;
+    int64_t b = node->binary.right->literal.i;
+
+    switch (node->binary.op.kind) {
+    case TOKEN_PLUS:
+        return new_int(self, node, (int64_t) ((uint64_t) a + (uint64_t) b));
+    case TOKEN_MINUS:
+        return new_int(self, node, (int64_t) ((uint64_t) a - (uint64_t) b));
+    case TOKEN_MUL:
+        return new_int(self, node, (int64_t) ((uint64_t) a * (uint64_t) b));
+    case TOKEN_DIV:
+    case TOKEN_MOD:
+        /* left for the interpreter to report */
+        if (b == 0 || (a == INT64_MIN && b == -1)) {
+            return node;
+        }
+
+        return new_int(
+            self, node, node->binary.op.kind == TOKEN_DIV ? a / b : a % b
+        );
+    case TOKEN_EQUAL:
+        return new_int(self, node, a == b);
+    case TOKEN_NOT_EQUAL:
+        return new_int(self, node, a != b);
+    case TOKEN_LESS:
+        return new_int(self, node, a < b);
+    case TOKEN_GREATER:
+        return new_int(self, node, a > b);
+    case TOKEN_LESS_EQUAL:
+        return new_int(self, node, a <= b);
+    case TOKEN_GREATER_EQUAL:
+        return new_int(self, node, a >= b);
+    case TOKEN_AND:
+        return new_int(self, node, a && b);
+    case TOKEN_OR:
+        return new_int(self, node, a || b);
+    default:
+        return node;
+    }
+}
+
+static AstNode *fold_string_binary(Optimizer *self, AstNode *node) {
+    const StrBuf *a = &node->binary.left->literal.str;
+    const StrBuf *b = &node->binary.right->literal.str;
+
+    switch (node->binary.op.kind) {
+    case TOKEN_PLUS: {
+        AstNode *lit = new_string(node);
+        str_dup_n(&lit->literal.str, str_data(a), str_len(a));
+        str_cat(&lit->literal.str, b);
+
+        return replace(self, node, lit);
+    }
+    case TOKEN_EQUAL:
+        return new_int(self, node, str_equal(a, b));
+    case TOKEN_NOT_EQUAL:
+        return new_int(self, node, !str_equal(a, b));
+    default:
+        return node;
+    }
+}
+
+static AstNode *fold_binary(Optimizer *self, AstNode *node) {
+    node->binary.left = fold_expr(self, node->binary.left);
+    node->binary.right = fold_expr(self, node->binary.right);
+
+    const AstNode *left = node->binary.left;
+    const AstNode *right = node->binary.right;
+    TokenKind op = node->binary.op.kind;
+
+    /* The right operand isn't evaluated if the left one decides the result */
+    if ((op == TOKEN_AND || op == TOKEN_OR) && is_int(left) &&
+        (left->literal.i != 0) == (op == TOKEN_OR)) {
+        return new_int(self, node, op == TOKEN_OR);
+    }
+
+    if (is_int(left) && is_int(right)) {
+        return fold_int_binary(self, node);
+    } else if (is_string(left) && is_string(right)) {
+        return fold_string_binary(self, node);
+    }
+
+    return node;
+}
+
+/*
+ * Tells if evaluating the expression has no side effects, so it can be moved
+ * or repeated. Sets may_fail if it can raise a runtime error.
+ */
+static bool is_pure(const AstNode *node, bool *may_fail) {
+    switch (node->kind) {
+    case AST_NODE_INTEGER:
+    case AST_NODE_STRING:
+    case AST_NODE_NIL:
+    case AST_NODE_IDENT:
+        return true;
+    case AST_NODE_GROUPING:
+        return is_pure(node->grouping.expr, may_fail);
+    case AST_NODE_UNARY:
+        switch (node->unary.op.kind) {
+        case TOKEN_INC:
+        case TOKEN_DEC:
+            return false;
+        case TOKEN_MUL:
+            /* empty options can't be dereferenced */
+            *may_fail = true;
+
+            break;
+        default:
+            break;
+        }
+
+        return is_pure(node->unary.right, may_fail);
+    case AST_NODE_BINARY:
+        switch (node->binary.op.kind) {
+        case TOKEN_PLUS:
+            /* concatenation may reuse the buffer of its left operand */
+            if (node->type->id != TYPE_INT) {
+                return false;
+            }
+
+            break;
+        case TOKEN_DIV:
+        case TOKEN_MOD:
+            *may_fail = true;
+
+            break;
+        case TOKEN_MINUS:
+        case TOKEN_MUL:
+        case TOKEN_EQUAL:
+        case TOKEN_NOT_EQUAL:
+        case TOKEN_LESS:
+        case TOKEN_GREATER:
+        case TOKEN_LESS_EQUAL:
+        case TOKEN_GREATER_EQUAL:
+        case TOKEN_AND:
+        case TOKEN_OR:
+            break;
+        default:
+            return false;
+        }
+
+        return is_pure(node->binary.left, may_fail) &&
+               is_pure(node->binary.right, may_fail);
+    case AST_NODE_SUBSCRIPT:
+        /* the index may be out of range */
+        *may_fail = true;
+
+        return is_pure(node->subscript.left, may_fail) &&
+               is_pure(node->subscript.expr, may_fail);
+    case AST_NODE_SLICE:
+        /* the bounds may be out of range */
+        *may_fail = true;
+
+        return is_pure(node->slice.left, may_fail) &&
+               (!node->slice.start || is_pure(node->slice.start, may_fail)) &&
+               (!node->slice.end || is_pure(node->slice.end, may_fail));
+    case AST_NODE_FIELD:
+        return is_pure(node->field.left, may_fail);
+    case AST_NODE_FN_CALL: {
+        const char *name = node->fn_call.name->ident.name;
+
+        if (strcmp(name, "ord") != 0 && strcmp(name, "chr") != 0) {
+            return false;
+        }
+
+        return is_pure(((AstNode **) node->fn_call.values.data)[0], may_fail);
+    }
+    default:
+        return false;
+    }
+}
+
+static size_t count_nodes(const AstNode *node) {
+    switch (node->kind) {
+    case AST_NODE_GROUPING:
+        return 1 + count_nodes(node->grouping.expr);
+    case AST_NODE_UNARY:
+        return 1 + count_nodes(node->unary.right);
+    case AST_NODE_BINARY:
+        return 1 + count_nodes(node->binary.left) +
+               count_nodes(node->binary.right);
+    case AST_NODE_SUBSCRIPT:
+        return 1 + count_nodes(node->subscript.left) +
+               count_nodes(node->subscript.expr);
+    case AST_NODE_SLICE:
+        return 1 + count_nodes(node->slice.left) +
+               (node->slice.start ? count_nodes(node->slice.start) : 0) +
+               (node->slice.end ? count_nodes(node->slice.end) : 0);
+    case AST_NODE_FIELD:
+        return 1 + count_nodes(node->field.left);
+    case AST_NODE_FN_CALL: {
+        size_t count = 1;
+        AstNode **args = node->fn_call.values.data;
+
+        for (size_t i = 0; i < node->fn_call.values.len; ++i) {
+            count += count_nodes(args[i]);
+        }
+
+        return count;
+    }
+    default:
+        return 1;
+    }
+}
+
+/* The expression returned by the function, if its body is just a return */
+static AstNode *returned_expr(const AstNode *fn) {
+    const AstNode *body = fn->fn_decl.body;
+
+    if (body && body->kind == AST_NODE_BLOCK && body->block.nodes.len == 1) {
+        body = ((AstNode **) body->block.nodes.data)[0];
+    }
+
+    if (!body || body->kind != AST_NODE_RETURN) {
+        return NULL;
+    }
+
+    return body->kw_return.expr;
+}
+
+/* Index of the parameter the identifier refers to, or -1 */
+static int param_index(const AstNode *fn, const AstNode *ident) {
+    if (ident->ident.depth == VAR_GLOBAL_DEPTH) {
+        return -1;
+    }
+
+    AstNode **params = fn->fn_decl.params.data;
+
+    for (size_t i = 0; i < fn->fn_decl.params.len; ++i) {
+        const AstNode *name = params[i]->param_decl.name;
+
+        if (name->ident.depth == ident->ident.depth &&
+            name->ident.slot == ident->ident.slot) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+typedef struct ParamUses {
+    /* Number of times the parameter is evaluated */
+    size_t count[INLINE_MAX_PARAMS];
+    /* Order in which the parameters are surely evaluated first, or -1 if they
+     * may be skipped by && or || */
+    int first[INLINE_MAX_PARAMS];
+    int evaluated;
+} ParamUses;
+
+static void find_param_uses(
+    const AstNode *fn, const AstNode *node, bool conditional, ParamUses *uses
+) {
+    switch (node->kind) {
+    case AST_NODE_IDENT: {
+        int idx = param_index(fn, node);
+
+        if (idx < 0) {
+            break;
+        }
+
+        ++uses->count[idx];
+
+        if (!conditional && uses->first[idx] < 0) {
+            uses->first[idx] = uses->evaluated++;
+        }
+
+        break;
+    }
+    case AST_NODE_GROUPING:
+        find_param_uses(fn, node->grouping.expr, conditional, uses);
+
+        break;
+    case AST_NODE_UNARY:
+        find_param_uses(fn, node->unary.right, conditional, uses);
+
+        break;
+    case AST_NODE_BINARY: {
+        TokenKind op = node->binary.op.kind;
+
+        find_param_uses(fn, node->binary.left, conditional, uses);
+        find_param_uses(
+            fn, node->binary.right,
+            conditional || op == TOKEN_AND || op == TOKEN_OR, uses
+        );
+
+        break;
+    }
+    case AST_NODE_SUBSCRIPT:
+        find_param_uses(fn, node->subscript.left, conditional, uses);
+        find_param_uses(fn, node->subscript.expr, conditional, uses);
+
+        break;
+    case AST_NODE_SLICE:
+        find_param_uses(fn, node->slice.left, conditional, uses);
+
+        if (node->slice.start) {
+            find_param_uses(fn, node->slice.start, conditional, uses);
+        }
+
+        if (node->slice.end) {
+            find_param_uses(fn, node->slice.end, conditional, uses);
+        }
+
+        break;
+    case AST_NODE_FIELD:
+        find_param_uses(fn, node->field.left, conditional, uses);
+
+        break;
+    case AST_NODE_FN_CALL: {
+        AstNode **args = node->fn_call.values.data;
+
+        for (size_t i = 0; i < node->fn_call.values.len; ++i) {
+            find_param_uses(fn, args[i], conditional, uses);
+        }
+
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*
+ * Functions returning a single pure int expression are inlined. The result is
+ * always copied, and since neither the body nor the arguments can mutate
+ * anything, it doesn't matter whether the arguments were passed by reference.
+ */
+static bool can_inline_fn(const AstNode *fn) {
+    const AstNode *expr = returned_expr(fn);
+    bool may_fail = false;
+
+    return expr && fn->fn_decl.type->type->id == TYPE_INT &&
+           fn->fn_decl.params.len <= INLINE_MAX_PARAMS &&
+           count_nodes(expr) <= INLINE_MAX_COST && is_pure(expr, &may_fail);
+}
+
+/*
+ * Arguments are substituted for the parameters, so they're evaluated where
+ * the parameters are used. The arguments that can fail must be still
+ * evaluated in order and before anything else that can fail.
+ */
+static bool can_inline_call(const AstNode *fn, AstNode **args) {
+    const AstNode *expr = returned_expr(fn);
+    AstNode **params = fn->fn_decl.params.data;
+    size_t nparams = fn->fn_decl.params.len;
+
+    ParamUses uses = {0};
+
+    for (size_t i = 0; i < nparams; ++i) {
+        uses.first[i] = -1;
+    }
+
+    find_param_uses(fn, expr, false, &uses);
+
+    bool body_fails = false;
+    is_pure(expr, &body_fails);
+
+    size_t cost = count_nodes(expr);
+    int last_failing = -1;
+
+    for (size_t i = 0; i < nparams; ++i) {
+        bool arg_fails = false;
+
+        /* no implicit conversion to an option */
+        if (!type_equal(args[i]->type, params[i]->param_decl.type->type) ||
+            !is_pure(args[i], &arg_fails)) {
+            return false;
+        }
+
+        if (arg_fails) {
+            if (body_fails || uses.first[i] <= last_failing) {
+                return false;
+            }
+
+            last_failing = uses.first[i];
+        }
+
+        cost += count_nodes(args[i]) * uses.count[i];
+    }
+
+    return cost <= INLINE_MAX_COST;
+}
+
+static bool is_lvalue(const AstNode *node) {
+    switch (node->kind) {
+    case AST_NODE_IDENT:
+    case AST_NODE_SUBSCRIPT:
+    case AST_NODE_FIELD:
+        return true;
+    case AST_NODE_UNARY:
+        return node->unary.op.kind == TOKEN_MUL;
+    case AST_NODE_GROUPING:
+        return is_lvalue(node->grouping.expr);
+    default:
+        return false;
+    }
+}
+
+/* Replaces the parameters in the cloned body by the arguments */
+static AstNode *
+substitute(const AstNode *fn, AstNode *node, AstNode **args) {
+    switch (node->kind) {
+    case AST_NODE_IDENT: {
+        int idx = param_index(fn, node);
+
+        if (idx < 0) {
+            return node;
+        }
+
+        astnode_destroy(node);
+
+        return astnode_clone(args[idx]);
+    }
+    case AST_NODE_GROUPING:
+        node->grouping.expr = substitute(fn, node->grouping.expr, args);
+
+        break;
+    case AST_NODE_UNARY:
+        node->unary.right = substitute(fn, node->unary.right, args);
+
+        break;
+    case AST_NODE_BINARY:
+        node->binary.left = substitute(fn, node->binary.left, args);
+        node->binary.right = substitute(fn, node->binary.right, args);
+
+        break;
+    case AST_NODE_SUBSCRIPT:
+        node->subscript.left = substitute(fn, node->subscript.left, args);
+        node->subscript.expr = substitute(fn, node->subscript.expr, args);
+
+        break;
+    case AST_NODE_SLICE:
+        node->slice.left = substitute(fn, node->slice.left, args);
+
+        if (node->slice.start) {
+            node->slice.start = substitute(fn, node->slice.start, args);
+        }
+
+        if (node->slice.end) {
+            node->slice.end = substitute(fn, node->slice.end, args);
+        }
+
+        break;
+    case AST_NODE_FIELD:
+        node->field.left = substitute(fn, node->field.left, args);
+
+        break;
+    case AST_NODE_FN_CALL: {
+        AstNode **values = node->fn_call.values.data;
+
+        for (size_t i = 0; i < node->fn_call.values.len; ++i) {
+            values[i] = substitute(fn, values[i], args);
+        }
+
+        break;
+    }
+    default:
+        break;
+    }
+
+    return node;
+}
+
+static AstNode *inline_call(Optimizer *self, AstNode *node) {
+    const AstNode *fn =
+        sym_map_get(&self->inline_fns, node->fn_call.name->ident.name);
+    AstNode **args = node->fn_call.values.data;
+
+    if (!fn || !can_inline_call(fn, args)) {
+        return node;
+    }
+
+    AstNode *result = substitute(fn, astnode_clone(returned_expr(fn)), args);
+
+    /* The result of a call is a value, it mustn't become a reference to an
+     * element passed to another function */
+    if (is_lvalue(result)) {
+        AstNode *value = astnode_new(AST_NODE_UNARY, &node->tok);
+        value->type = node->type;
+        value->unary.op = node->tok;
+        value->unary.op.kind = TOKEN_PLUS;
+        value->unary.right = result;
+
+        result = value;
+    }
+
+    astnode_destroy(node);
+    ++self->inlined;
+
+    return fold_expr(self, result);
+}
+
+/* Builtins without side effects are evaluated if their arguments are
+ * literals */
+static AstNode *fold_fn_call(Optimizer *self, AstNode *node) {
+    AstNode **args = node->fn_call.values.data;
+
+    for (size_t i = 0; i < node->fn_call.values.len; ++i) {
+        args[i] = fold_expr(self, args[i]);
+    }
+
+    if (node->fn_call.values.len != 1) {
+        return inline_call(self, node);
+    }
+
+    /* Builtins can't be redefined, so the name is enough */
+    const char *name = node->fn_call.name->ident.name;
+
+    if (strcmp(name, "ord") == 0 && is_string(args[0])) {
+        return new_int(self, node, str_data(&args[0]->literal.str)[0]);
+    } else if (strcmp(name, "chr") == 0 && is_int(args[0])) {
+        AstNode *lit = new_string(node);
+        str_init_n(&lit->literal.str, 1);
+        str_data(&lit->literal.str)[0] = (char) args[0]->literal.i;
+
+        return replace(self, node, lit);
+    }
+
+    return inline_call(self, node);
+}
+
+static AstNode *fold_expr(Optimizer *self, AstNode *node) {
+    switch (node->kind) {
+    case AST_NODE_UNARY:
+        return fold_unary(self, node);
+    case AST_NODE_BINARY:
+        return fold_binary(self, node);
+    case AST_NODE_SUFFIX:
+        node->suffix.left = fold_expr(self, node->suffix.left);
+
+        return node;
+    case AST_NODE_GROUPING: {
+        AstNode *expr = fold_expr(self, node->grouping.expr);
+
+        if (!is_int(expr) && !is_string(expr)) {
+            node->grouping.expr = expr;
+
+            return node;
+        }
+
+        node->grouping.expr = NULL;
+        astnode_destroy(node);
+
+        return expr;
+    }
+    case AST_NODE_FN_CALL:
+        return fold_fn_call(self, node);
+    case AST_NODE_SUBSCRIPT:
+        node->subscript.left = fold_expr(self, node->subscript.left);
+        node->subscript.expr = fold_expr(self, node->subscript.expr);
+
+        return node;
+    case AST_NODE_SLICE:
+        node->slice.left = fold_expr(self, node->slice.left);
+
+        if (node->slice.start) {
+            node->slice.start = fold_expr(self, node->slice.start);
+        }
+
+        if (node->slice.end) {
+            node->slice.end = fold_expr(self, node->slice.end);
+        }
+
+        return node;
+    case AST_NODE_FIELD:
+        node->field.left = fold_expr(self, node->field.left);
+
+        return node;
+    default:
+        return node;
+    }
+}
+
+static AstNode *optimize_stmt(Optimizer *self, AstNode *node);
+
+/* Optimizes the statements in place, dropping the removed ones */
+static void optimize_stmts(Optimizer *self, Vector *stmts) {
+    AstNode **nodes = stmts->data;
+    size_t len = 0;
+    bool top_level = self->top_level;
+
+    for (size_t i = 0; i < stmts->len; ++i) {
+        self->top_level = top_level;
+        AstNode *node = optimize_stmt(self, nodes[i]);
+
+        if (node) {
+            nodes[len++] = node;
+        }
+    }
+
+    stmts->len = len;
+}
+
+static AstNode *optimize_if(Optimizer *self, AstNode *node) {
+    node->kw_if.cond = fold_expr(self, node->kw_if.cond);
+
+    if (node->kw_if.body) {
+        node->kw_if.body = optimize_stmt(self, node->kw_if.body);
+    }
+
+    if (node->kw_if.else_body) {
+        node->kw_if.else_body = optimize_stmt(self, node->kw_if.else_body);
+    }
+
+    if (!is_int(node->kw_if.cond)) {
+        return node;
+    }
+
+    AstNode *taken;
+
+    /* The taken branch keeps its own scope, if it has any */
+    if (node->kw_if.cond->literal.i) {
+        taken = node->kw_if.body;
+        node->kw_if.body = NULL;
+    } else {
+        taken = node->kw_if.else_body;
+        node->kw_if.else_body = NULL;
+    }
+
+    astnode_destroy(node);
+    ++self->pruned;
+
+    return taken;
+}
+
+static AstNode *optimize_while(Optimizer *self, AstNode *node) {
+    node->kw_while.cond = fold_expr(self, node->kw_while.cond);
+
+    if (node->kw_while.body) {
+        node->kw_while.body = optimize_stmt(self, node->kw_while.body);
+    }
+
+    if (is_int(node->kw_while.cond) && !node->kw_while.cond->literal.i) {
+        astnode_destroy(node);
+        ++self->pruned;
+
+        return NULL;
+    }
+
+    return node;
+}
+
+static AstNode *optimize_stmt(Optimizer *self, AstNode *node) {
+    /* Statements nested in this one may never run */
+    bool top_level = self->top_level;
+    self->top_level = false;
+
+    switch (node->kind) {
+    case AST_NODE_BLOCK:
+        optimize_stmts(self, &node->block.nodes);
+
+        return node;
+    case AST_NODE_VAR_DECL: {
+        AstNode *type = node->var_decl.type;
+
+        if (type->kind == AST_NODE_LIST_TYPE && type->list_type.size) {
+            type->list_type.size = fold_expr(self, type->list_type.size);
+        }
+
+        if (node->var_decl.rvalue) {
+            node->var_decl.rvalue = fold_expr(self, node->var_decl.rvalue);
+        }
+
+        return node;
+    }
+    case AST_NODE_FN_DECL: {
+        AstNode *body = node->fn_decl.body;
+
+        if (!body) {
+            return node;
+        }
+
+        node->fn_decl.body = optimize_stmt(self, body);
+
+        /* A function without a body is only declared */
+        if (!node->fn_decl.body) {
+            node->fn_decl.body = astnode_new(AST_NODE_BLOCK, &node->tok);
+            vec_init(&node->fn_decl.body->block.nodes, sizeof(AstNode *));
+        }
+
+        Symbol name = node->fn_decl.name->ident.name;
+
+        /* Only functions that are surely declared are inlined. A nested one
+         * may also shadow an inlinable function from here on. Recursive
+         * functions are never inlined, since calls of user functions aren't
+         * pure. */
+        if (top_level && can_inline_fn(node)) {
+            sym_map_add(&self->inline_fns, name, node);
+        } else {
+            sym_map_remove(&self->inline_fns, name);
+        }
+
+        return node;
+    }
+    case AST_NODE_IF:
+        return optimize_if(self, node);
+    case AST_NODE_WHILE:
+        return optimize_while(self, node);
+    case AST_NODE_FOR:
+        if (node->kw_for.init) {
+            node->kw_for.init = optimize_stmt(self, node->kw_for.init);
+        }
+
+        if (node->kw_for.cond) {
+            node->kw_for.cond = fold_expr(self, node->kw_for.cond);
+        }
+
+        if (node->kw_for.iter) {
+            node->kw_for.iter = fold_expr(self, node->kw_for.iter);
+        }
+
+        if (node->kw_for.body) {
+            node->kw_for.body = optimize_stmt(self, node->kw_for.body);
+        }
+
+        return node;
+    case AST_NODE_FOR_EACH:
+        node->kw_for_each.map = fold_expr(self, node->kw_for_each.map);
+
+        if (node->kw_for_each.body) {
+            node->kw_for_each.body =
+                optimize_stmt(self, node->kw_for_each.body);
+        }
+
+        return node;
+    case AST_NODE_RETURN:
+        if (node->kw_return.expr) {
+            node->kw_return.expr = fold_expr(self, node->kw_return.expr);
+        }
+
+        return node;
+    case AST_NODE_BREAK:
+    case AST_NODE_CONTINUE:
+    case AST_NODE_STRUCT_DECL:
+        return node;
+    default:
+        return fold_expr(self, node);
+    }
+}
+
+void optimizer_init(Optimizer *self) {
+    hashmap_init(&self->inline_fns);
+
+    self->top_level = false;
+    self->folded = 0;
+    self->pruned = 0;
+    self->inlined = 0;
+}
+
+void optimizer_deinit(Optimizer *self) {
+    hashmap_deinit(&self->inline_fns);
+}
+
+void optimizer_optimize(Optimizer *self, Ast *ast) {
+    self->top_level = true;
+    optimize_stmts(self, &ast->nodes);
+}
@@ -26,9 +26,11 @@ static AstNode *suffix(Parser *self, AstNode *left);
 static AstNode *grouping(Parser *self);
 static AstNode *fn_call(Parser *self, AstNode *left);
 static AstNode *subscript(Parser *self, AstNode *left);
+static AstNode *field(Parser *self, AstNode *left);
 static AstNode *block(Parser *self);
 static AstNode *statement(Parser *self);
 static AstNode *declaration(Parser *self);
+static AstNode *param_decl(Parser *self);
 
 /* clang-format off */
 static ParseRule g_rules[] = {
@@ -39,6 +41,8 @@ static ParseRule g_rules[] = {
     [TOKEN_STRING_LIT]     = {string_literal,  NULL,    NULL,      PREC_NONE},
     [TOKEN_COMMA]          = {NULL,            NULL,    NULL,      PREC_NONE},
     [TOKEN_SEMICOLON]      = {NULL,            NULL,    NULL,      PREC_NONE},
+    [TOKEN_COLON]          = {NULL,            NULL,    NULL,      PREC_NONE},
+    [TOKEN_DOT]            = {NULL,            NULL,    field,     PREC_SUFFIX},
     [TOKEN_LPAREN]         = {grouping,        fn_call, NULL,      PREC_SUFFIX},
     [TOKEN_RPAREN]         = {NULL,            NULL,    NULL,      PREC_NONE},
     [TOKEN_LBRACKET]       = {NULL,            NULL,    subscript, PREC_SUFFIX},
@@ -78,7 +82,9 @@ static ParseRule g_rules[] = {
     [TOKEN_NIL]            = {nil_constant,    NULL,    NULL,      PREC_NONE},
     [TOKEN_INT]            = {NULL,            NULL,    NULL,      PREC_NONE},
     [TOKEN_VOID]           = {NULL,            NULL,    NULL,      PREC_NONE},
-    [TOKEN_STRING]         = {NULL,            NULL,    NULL,      PREC_NONE}
+    [TOKEN_STRING]         = {NULL,            NULL,    NULL,      PREC_NONE},
+    [TOKEN_MAP]            = {NULL,            NULL,    NULL,      PREC_NONE},
+    [TOKEN_STRUCT]         = {NULL,            NULL,    NULL,      PREC_NONE}
 };
 /* clang-format on */
 
@@ -225,6 +231,8 @@ static void sync(Parser *self, unsigned modes) {
             case TOKEN_INT:
             case TOKEN_STRING:
             case TOKEN_VOID:
+            case TOKEN_MAP:
+            case TOKEN_STRUCT:
             case TOKEN_RETURN:
             case TOKEN_BREAK:
             case TOKEN_CONTINUE:
@@ -289,7 +297,7 @@ static AstNode *string_literal(Parser *self) {
 
 static AstNode *identifier(Parser *self) {
     AstNode *node = astnode_new(AST_NODE_IDENT, self->curr);
-    str_dup_n(&node->ident.str, self->curr->src, self->curr->len);
+    node->ident.name = sym_intern(self->curr->src, self->curr->len);
 
     advance(self); /* consume the identifier */
 
@@ -433,12 +441,46 @@ static AstNode *fn_call(Parser *self, AstNode *left) {
     return node;
 }
 
+/* [start:end], where either of the bounds can be omitted */
+static AstNode *slice(Parser *self, AstNode *left, AstNode *start, Token tok) {
+    advance(self); /* consume the : */
+
+    AstNode *end = NULL;
+
+    if (!match(self, TOKEN_RBRACKET)) {
+        end = expression(self, PREC_NONE);
+    }
+
+    if (!expect(self, TOKEN_RBRACKET)) {
+        astnode_destroy(start);
+        astnode_destroy(end);
+        astnode_destroy(left);
+
+        return astnode_new(AST_NODE_ERROR, self->curr);
+    }
+
+    AstNode *node = astnode_new(AST_NODE_SLICE, &tok);
+    node->slice.left = left;
+    node->slice.start = start;
+    node->slice.end = end;
+
+    return node;
+}
+
 static AstNode *subscript(Parser *self, AstNode *left) {
     Token tok = *self->curr;
     advance(self); /* consume the [ */
 
+    if (match(self, TOKEN_COLON)) {
+        return slice(self, left, NULL, tok);
+    }
+
     AstNode *expr = expression(self, PREC_NONE);
 
+    if (match(self, TOKEN_COLON)) {
+        return slice(self, left, expr, tok);
+    }
+
     if (!expect(self, TOKEN_RBRACKET)) {
         astnode_destroy(expr);
         astnode_destroy(left);
@@ -453,6 +495,24 @@ static AstNode *subscript(Parser *self, AstNode *left) {
     return node;
 }
 
+static AstNode *field(Parser *self, AstNode *left) {
+    Token tok = *self->curr;
+    advance(self); /* consume the . */
+
+    if (!match(self, TOKEN_IDENTIFIER)) {
+        error_at(self, "expected field name");
+        astnode_destroy(left);
+
+        return astnode_new(AST_NODE_ERROR, self->curr);
+    }
+
+    AstNode *node = astnode_new(AST_NODE_FIELD, &tok);
+    node->field.left = left;
+    node->field.name = identifier(self);
+
+    return node;
+}
+
 static AstNode *block(Parser *self) {
     AstNode *block = astnode_new(AST_NODE_BLOCK, self->curr);
     vec_init(&block->block.nodes, sizeof(AstNode *));
@@ -655,6 +715,7 @@ static bool token_is_type(TokenKind tok) {
     case TOKEN_INT:
     case TOKEN_STRING:
     case TOKEN_VOID:
+    case TOKEN_MAP:
     case TOKEN_LBRACKET:
         return true;
     default:
@@ -662,6 +723,79 @@ static bool token_is_type(TokenKind tok) {
     }
 }
 
+/* Point p and Point? p declare variables of a struct type, while an
+ * expression can't have two operands in a row */
+static bool struct_type_ahead(const Parser *self) {
+    if (!match(self, TOKEN_IDENTIFIER)) {
+        return false;
+    }
+
+    TokenKind next = self->curr[1].kind;
+
+    return next == TOKEN_IDENTIFIER || next == TOKEN_QUEST;
+}
+
+static bool type_ahead(const Parser *self) {
+    return token_is_type(self->curr->kind) || struct_type_ahead(self);
+}
+
+/* The header of for (T key : map) has a colon before any assignment or
+ * semicolon */
+static bool for_each_ahead(const Parser *self) {
+    for (const Token *tok = self->curr; tok->kind != TOKEN_EOF; ++tok) {
+        switch (tok->kind) {
+        case TOKEN_COLON:
+            return true;
+        case TOKEN_ASSIGN:
+        case TOKEN_SEMICOLON:
+        case TOKEN_LBRACE:
+            return false;
+        default:
+            break;
+        }
+    }
+
+    return false;
+}
+
+static AstNode *for_each_statement(Parser *self, const Token *for_tok) {
+    AstNode *var = param_decl(self);
+
+    if (var->kind == AST_NODE_ERROR || !expect(self, TOKEN_COLON)) {
+        Token tok = *self->curr;
+
+        sync(self, SYNC_TO_SEMICOLON_SKIP | SYNC_TO_BLOCK | SYNC_TO_STATEMENT);
+        astnode_destroy(var);
+
+        return astnode_new(AST_NODE_ERROR, &tok);
+    }
+
+    AstNode *map = expression(self, PREC_NONE);
+
+    if (map->kind == AST_NODE_ERROR || !expect(self, TOKEN_RPAREN)) {
+        Token tok = *self->curr;
+
+        sync(self, SYNC_TO_SEMICOLON_SKIP | SYNC_TO_BLOCK | SYNC_TO_STATEMENT);
+        astnode_destroy(var);
+        astnode_destroy(map);
+
+        return astnode_new(AST_NODE_ERROR, &tok);
+    }
+
+    AstNode *body = statement(self);
+
+    if (body && body->kind == AST_NODE_ERROR) {
+        sync(self, SYNC_TO_SEMICOLON_SKIP | SYNC_TO_BLOCK | SYNC_TO_STATEMENT);
+    }
+
+    AstNode *stmt = astnode_new(AST_NODE_FOR_EACH, for_tok);
+    stmt->kw_for_each.var = var;
+    stmt->kw_for_each.map = map;
+    stmt->kw_for_each.body = body;
+
+    return stmt;
+}
+
 static AstNode *for_statement(Parser *self) {
     Token for_tok = *self->curr;
     advance(self);
@@ -673,9 +807,13 @@ static AstNode *for_statement(Parser *self) {
         return astnode_new(AST_NODE_ERROR, &tok);
     }
 
+    if (type_ahead(self) && for_each_ahead(self)) {
+        return for_each_statement(self, &for_tok);
+    }
+
     AstNode *init = NULL;
 
-    if (token_is_type(self->curr->kind)) {
+    if (type_ahead(self)) {
         init = optional_var_decl_with_delimiter(self, TOKEN_SEMICOLON);
     } else {
         init = optional_expression_with_delimiter(self, TOKEN_SEMICOLON);
@@ -718,6 +856,8 @@ static AstNode *return_statement(Parser *self) {
     return node;
 }
 
+static AstNode *struct_decl(Parser *self);
+
 static AstNode *statement(Parser *self) {
     AstNode *stmt = NULL;
     TokenKind stmt_kind = self->curr->kind;
@@ -742,10 +882,13 @@ static AstNode *statement(Parser *self) {
     case TOKEN_INT:
     case TOKEN_STRING:
     case TOKEN_VOID:
+    case TOKEN_MAP:
     case TOKEN_LBRACKET:
         stmt = declaration(self);
 
         break;
+    case TOKEN_STRUCT:
+        return struct_decl(self);
     case TOKEN_RETURN:
         stmt = return_statement(self);
 
@@ -763,7 +906,11 @@ static AstNode *statement(Parser *self) {
 
         break;
     default:
-        stmt = expression(self, PREC_NONE);
+        if (struct_type_ahead(self)) {
+            stmt = declaration(self);
+        } else {
+            stmt = expression(self, PREC_NONE);
+        }
 
         break;
     }
@@ -798,6 +945,14 @@ static AstNode *parse_type(Parser *self) {
     case TOKEN_LBRACKET:
         type_id = AST_NODE_LIST_TYPE;
 
+        break;
+    case TOKEN_MAP:
+        type_id = AST_NODE_MAP_TYPE;
+
+        break;
+    case TOKEN_IDENTIFIER:
+        type_id = AST_NODE_STRUCT_TYPE;
+
         break;
     default:
         type_id = AST_NODE_ERROR;
@@ -811,7 +966,10 @@ static AstNode *parse_type(Parser *self) {
     Token type_tok = *self->prev;
 
     if (type_id == AST_NODE_ERROR) {
-        error_at(self, "expected type specifier: int, string, void or list");
+        error_at(
+            self, "expected type specifier: int, string, void, list, map or "
+                  "struct name"
+        );
 
         return astnode_new(AST_NODE_ERROR, self->curr);
     } else if (type_id == AST_NODE_LIST_TYPE) {
@@ -840,6 +998,32 @@ static AstNode *parse_type(Parser *self) {
         node = astnode_new(type_id, &type_tok);
         node->list_type.type = type;
         node->list_type.size = size;
+    } else if (type_id == AST_NODE_MAP_TYPE) {
+        AstNode *key = NULL;
+        AstNode *value = NULL;
+
+        if (expect(self, TOKEN_LESS)) {
+            key = parse_type(self);
+        }
+
+        if (key && key->kind != AST_NODE_ERROR && expect(self, TOKEN_COMMA)) {
+            value = parse_type(self);
+        }
+
+        if (!value || value->kind == AST_NODE_ERROR ||
+            !expect(self, TOKEN_GREATER)) {
+            astnode_destroy(key);
+            astnode_destroy(value);
+
+            return astnode_new(AST_NODE_ERROR, self->curr);
+        }
+
+        node = astnode_new(type_id, &type_tok);
+        node->map_type.key = key;
+        node->map_type.value = value;
+    } else if (type_id == AST_NODE_STRUCT_TYPE) {
+        node = astnode_new(type_id, &type_tok);
+        node->struct_type.name = sym_intern(type_tok.src, type_tok.len);
     } else {
         node = astnode_new(type_id, &type_tok);
     }
@@ -939,6 +1123,76 @@ fn_decl(Parser *self, const Token *tok, AstNode *type, AstNode *name) {
     return node;
 }
 
+/* The rest of a bad struct declaration is skipped up to its right brace */
+static AstNode *bad_struct_decl(Parser *self, AstNode *name, Vector *fields) {
+    Token tok = *self->curr;
+    AstNode **nodes = fields->data;
+
+    for (size_t i = 0; i < fields->len; ++i) {
+        astnode_destroy(nodes[i]);
+    }
+
+    vec_deinit(fields);
+    astnode_destroy(name);
+
+    sync(self, SYNC_TO_RBRACE_SKIP);
+
+    if (match(self, TOKEN_RBRACE)) {
+        advance(self);
+    }
+
+    return astnode_new(AST_NODE_ERROR, &tok);
+}
+
+static AstNode *struct_decl(Parser *self) {
+    Token struct_tok = *self->curr;
+    advance(self); /* consume the struct keyword */
+
+    Vector fields;
+    vec_init(&fields, sizeof(AstNode *));
+
+    if (!match(self, TOKEN_IDENTIFIER)) {
+        error_at(self, "expected identifier");
+
+        return bad_struct_decl(self, NULL, &fields);
+    }
+
+    AstNode *name = identifier(self);
+
+    if (!expect(self, TOKEN_LBRACE)) {
+        return bad_struct_decl(self, name, &fields);
+    }
+
+    while (!match(self, TOKEN_RBRACE)) {
+        if (match(self, TOKEN_EOF)) {
+            error_at(self, "unterminated struct declaration");
+
+            return bad_struct_decl(self, name, &fields);
+        }
+
+        AstNode *decl = param_decl(self);
+        vec_push(&fields, &decl);
+
+        if (decl->kind == AST_NODE_ERROR || !expect(self, TOKEN_SEMICOLON)) {
+            return bad_struct_decl(self, name, &fields);
+        }
+    }
+
+    if (fields.len == 0) {
+        error_at(self, "expected field declaration");
+
+        return bad_struct_decl(self, name, &fields);
+    }
+
+    advance(self); /* consume right brace */
+
+    AstNode *node = astnode_new(AST_NODE_STRUCT_DECL, &struct_tok);
+    node->struct_decl.name = name;
+    node->struct_decl.fields = fields;
+
+    return node;
+}
+
 static AstNode *declaration(Parser *self) {
     Token decl_tok = *self->curr;
 
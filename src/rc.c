@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/arena.h>
+#include <monolog/rc.h>
+#include <monolog/utils.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define RC_STATIC SIZE_MAX
+#define RC_MAX_SIZE 0x7fffffffu
+
+/* Two words on 64-bit targets, so the object after the header stays
+ * aligned */
+typedef struct RcHeader {
+    size_t refs;
+    uint32_t pins;
+    /* Size of the allocation, header included */
+    uint32_t size : 31;
+    uint32_t view : 1;
+} RcHeader;
+
+/* Objects are freed one by one when their last reference is dropped, so the
+ * arena is shared by all interpreters and lives until rc_deinit() */
+static Arena g_arena;
+
+static RcHeader *header(const void *obj) {
+    return (RcHeader *) obj - 1;
+}
+
+void *rc_alloc(size_t size) {
+    size_t total = sizeof(RcHeader) + size;
+    RcHeader *hdr;
+
+    assert(total <= RC_MAX_SIZE);
+
+    if (total <= ARENA_MAX_SIZE) {
+        hdr = arena_alloc(&g_arena, total);
+    } else {
+        hdr = mem_alloc(total);
+    }
+
+    hdr->refs = 1;
+    hdr->size = (uint32_t) total & RC_MAX_SIZE;
+
+    return hdr + 1;
+}
+
+void rc_free(void *obj) {
+    RcHeader *hdr = header(obj);
+
+    if (hdr->size <= ARENA_MAX_SIZE) {
+        arena_free(&g_arena, hdr, hdr->size);
+    } else {
+        free(hdr);
+    }
+}
+
+void rc_deinit(void) {
+    arena_deinit(&g_arena);
+}
+
+ArenaStats rc_stats(void) {
+    return g_arena.stats;
+}
+
+void rc_retain(void *obj) {
+    RcHeader *hdr = header(obj);
+
+    if (hdr->refs != RC_STATIC) {
+        ++hdr->refs;
+    }
+}
+
+bool rc_release(void *obj) {
+    RcHeader *hdr = header(obj);
+
+    if (hdr->refs == RC_STATIC) {
+        return false;
+    }
+
+    assert(hdr->refs > 0);
+
+    return --hdr->refs == 0;
+}
+
+bool rc_shared(const void *obj) {
+    const RcHeader *hdr = header(obj);
+
+    /* references of pins belong to aliases of a single value */
+    return hdr->refs - hdr->pins > 1;
+}
+
+void rc_make_static(void *obj) {
+    header(obj)->refs = RC_STATIC;
+}
+
+void rc_make_view(void *obj) {
+    header(obj)->view = 1;
+}
+
+bool rc_is_view(const void *obj) {
+    return header(obj)->view;
+}
+
+void rc_pin(void *obj) {
+    ++header(obj)->pins;
+}
+
+void rc_unpin(void *obj) {
+    RcHeader *hdr = header(obj);
+
+    assert(hdr->pins > 0);
+    --hdr->pins;
+}
+
+bool rc_pinned(const void *obj) {
+    return header(obj)->pins > 0;
+}
@@ -6,88 +6,117 @@
  */
 
 #include <monolog/scope.h>
+#include <monolog/utils.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-void scope_init(Scope *self) {
-    vec_init(&self->values, sizeof(Value));
-    vec_init(&self->strings, sizeof(StrBuf));
-    vec_init(&self->lists, sizeof(Vector));
+static void *emplace(Vector *vec, size_t element_size) {
+    if (!vec->data) {
+        vec_init(vec, element_size);
+    }
 
-    hashmap_init(&self->vars);
+    return vec_emplace(vec);
+}
+
+static void destroy_var(Variable *var) {
+    if (!var->is_borrowed) {
+        value_release(&var->val);
+    }
+
+    free(var);
+}
+
+void scope_init(Scope *self) {
+    memset(self, 0, sizeof(*self));
 }
 
 void scope_deinit(Scope *self) {
     scope_clear(self);
     hashmap_deinit(&self->vars);
-    vec_deinit(&self->lists);
-    vec_deinit(&self->strings);
-    vec_deinit(&self->values);
+    vec_deinit(&self->slots);
 }
 
 void scope_clear(Scope *self) {
-    for (HashMapIter it = hashmap_iter(&self->vars); it.bucket != NULL;
-         hashmap_iter_next(&it)) {
-        Variable *var = it.bucket->value;
-
-        hashmap_remove(&self->vars, var->name);
+    Variable **slots = self->slots.data;
 
-        free(var->name);
-        var->name = NULL;
+    for (size_t i = 0; i < self->slots.len; ++i) {
+        Variable *var = slots[i];
 
-        free(var);
+        if (var) {
+            destroy_var(var);
+        }
     }
 
-    vec_clear(&self->values);
-
-    StrBuf *strings = self->strings.data;
+    if (self->vars.buckets) {
+        hashmap_clear(&self->vars);
+    }
 
-    for (size_t i = 0; i < self->strings.len; ++i) {
-        str_deinit(&strings[i]);
+    if (self->slots.len > 0) {
+        vec_clear(&self->slots);
     }
+}
 
-    vec_clear(&self->strings);
+/*
+ * Add a variable, that can be found by name. A redeclared variable takes the
+ * slot of the previous one.
+ */
+void scope_add_var(Scope *self, Variable *var) {
+    Variable *old_var = sym_map_get(&self->vars, var->name);
+    var->slot = old_var ? old_var->slot : (int) self->slots.len;
 
-    Vector *lists = self->lists.data;
+    scope_register_var(self, var);
+}
 
-    for (size_t i = 0; i < self->lists.len; ++i) {
-        vec_deinit(&lists[i]);
+/* Like scope_add_var(), but the slot has to be already assigned */
+void scope_register_var(Scope *self, Variable *var) {
+    scope_set_var(self, var);
+
+    if (!self->vars.buckets) {
+        hashmap_init(&self->vars);
     }
 
-    vec_clear(&self->lists);
+    sym_map_add(&self->vars, var->name, var);
 }
 
-void scope_add_var(Scope *self, Variable *var) {
-    Variable *old_var = hashmap_get(&self->vars, var->name);
+/* Destroy the variables in the slots from len on */
+void scope_truncate(Scope *self, size_t len) {
+    Variable **slots = self->slots.data;
 
-    if (old_var) {
-        hashmap_remove(&self->vars, old_var->name);
+    for (size_t i = len; i < self->slots.len; ++i) {
+        Variable *var = slots[i];
 
-        free(old_var->name);
-        old_var->name = NULL;
+        if (var) {
+            if (self->vars.buckets) {
+                sym_map_remove(&self->vars, var->name);
+            }
 
-        free(old_var);
+            destroy_var(var);
+        }
     }
 
-    hashmap_add(&self->vars, var->name, var);
+    if (self->slots.len > len) {
+        self->slots.len = len;
+    }
 }
 
-Value *scope_new_value(Scope *self, Type *type) {
-    Value *val = vec_emplace(&self->values);
-    val->type = type;
-    val->scope = self;
+/* Put the variable into its slot, destroying the previous occupant */
+void scope_set_var(Scope *self, Variable *var) {
+    size_t slot = (size_t) var->slot;
 
-    return val;
-}
+    while (self->slots.len <= slot) {
+        Variable **empty = emplace(&self->slots, sizeof(Variable *));
+        *empty = NULL;
+    }
 
-StrBuf *scope_new_string(Scope *self) {
-    return vec_emplace(&self->strings);
-}
+    Variable **slots = self->slots.data;
+    Variable *old_var = slots[slot];
 
-Vector *scope_new_list(Scope *self) {
-    Vector *list = vec_emplace(&self->lists);
-    vec_init(list, sizeof(Value));
+    if (old_var) {
+        sym_map_remove(&self->vars, old_var->name);
+        destroy_var(old_var);
+    }
 
-    return list;
+    slots[slot] = var;
 }
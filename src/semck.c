@@ -10,7 +10,6 @@
 #include <monolog/utils.h>
 
 #include <stdlib.h>
-#include <string.h>
 
 void error(SemChecker *self, const DiagnosticMessage *dmsg) {
     self->had_error = true;
@@ -18,12 +17,12 @@ void error(SemChecker *self, const DiagnosticMessage *dmsg) {
     vec_push(&self->dmsgs, dmsg);
 }
 
-static Type *check_expr(SemChecker *self, const AstNode *node);
+static Type *check_expr(SemChecker *self, AstNode *node);
 
-static bool expr_is_mutable(SemChecker *self, const AstNode *node) {
+static bool expr_is_mutable(SemChecker *self, AstNode *node) {
     switch (node->kind) {
     case AST_NODE_IDENT:
-        if (env_find_var(&self->env, node->ident.str.data)) {
+        if (env_find_var(&self->env, node->ident.name)) {
             return true;
         }
 
@@ -36,12 +35,14 @@ static bool expr_is_mutable(SemChecker *self, const AstNode *node) {
                    : false;
     case AST_NODE_SUBSCRIPT:
         return true;
+    case AST_NODE_FIELD:
+        return expr_is_mutable(self, node->field.left);
     default:
         return false;
     }
 }
 
-static Type *check_binary(SemChecker *self, const AstNode *node) {
+static Type *check_binary(SemChecker *self, AstNode *node) {
     TokenKind op = node->binary.op.kind;
     Type *t1 = check_expr(self, node->binary.left);
     Type *t2 = check_expr(self, node->binary.right);
@@ -236,7 +237,7 @@ static Type *check_binary(SemChecker *self, const AstNode *node) {
     }
 }
 
-static Type *check_unary(SemChecker *self, const AstNode *node) {
+static Type *check_unary(SemChecker *self, AstNode *node) {
     TokenKind op = node->unary.op.kind;
     Type *type = check_expr(self, node->unary.right);
 
@@ -273,7 +274,8 @@ static Type *check_unary(SemChecker *self, const AstNode *node) {
 
         return type;
     case TOKEN_HASHTAG:
-        if (type->id != TYPE_LIST && type->id != TYPE_STRING) {
+        if (type->id != TYPE_LIST && type->id != TYPE_STRING &&
+            type->id != TYPE_MAP) {
             goto bad_unary_operand;
         }
 
@@ -316,7 +318,7 @@ bad_unary_operand: {
 }
 }
 
-static Type *check_suffix(SemChecker *self, const AstNode *node) {
+static Type *check_suffix(SemChecker *self, AstNode *node) {
     TokenKind op = node->suffix.op.kind;
     Type *type = check_expr(self, node->suffix.left);
 
@@ -358,10 +360,11 @@ static Type *check_suffix(SemChecker *self, const AstNode *node) {
     }
 }
 
-static Type *check_ident(SemChecker *self, const AstNode *node) {
-    char *name = node->ident.str.data;
+static Type *check_ident(SemChecker *self, AstNode *node) {
+    Symbol name = node->ident.name;
 
-    Variable *var = env_find_var(&self->env, name);
+    int depth;
+    Variable *var = env_resolve_var(&self->env, name, &depth);
 
     if (!var) {
         DiagnosticMessage dmsg = {
@@ -375,12 +378,15 @@ static Type *check_ident(SemChecker *self, const AstNode *node) {
         return self->types->error_type;
     }
 
+    node->ident.depth = depth;
+    node->ident.slot = var->slot;
+
     return var->type;
 }
 
-static Type *check_fn_call(SemChecker *self, const AstNode *node) {
-    char *name = node->fn_call.name->ident.str.data;
-    Function *fn = hashmap_get(&self->env.funcs, name);
+static Type *check_fn_call(SemChecker *self, AstNode *node) {
+    Symbol name = node->fn_call.name->ident.name;
+    Function *fn = env_find_fn(&self->env, name);
 
     if (!fn) {
         DiagnosticMessage dmsg = {
@@ -422,10 +428,10 @@ static Type *check_fn_call(SemChecker *self, const AstNode *node) {
     }
 
     const FnParam *params = fn->params.data;
-    const AstNode **values = values_vec->data;
+    AstNode **values = values_vec->data;
 
     for (size_t i = 0; i < values_vec->len; ++i) {
-        const AstNode *value = values[i];
+        AstNode *value = values[i];
         const FnParam *param = &params[i];
 
         Type *value_type = check_expr(self, value);
@@ -449,14 +455,37 @@ static Type *check_fn_call(SemChecker *self, const AstNode *node) {
     return type;
 }
 
-static Type *check_subscript(SemChecker *self, const AstNode *node) {
-    const AstNode *expr = node->subscript.expr;
-    const AstNode *left = node->subscript.left;
+/* Looking up a key results in an option, which is empty if it's missing */
+static Type *
+check_map_subscript(SemChecker *self, AstNode *node, Type *map_type) {
+    AstNode *expr = node->subscript.expr;
+    Type *key_type = map_type->map_type.key;
+    Type *expr_type = check_expr(self, expr);
+
+    if (expr_type->id != TYPE_ERROR && !type_equal(expr_type, key_type)) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_MISMATCHED_TYPES,
+            .src_info = expr->tok.src_info,
+            .type_mismatch.expected = key_type,
+            .type_mismatch.found = expr_type
+        };
+
+        error(self, &dmsg);
+    }
+
+    return type_system_option(self->types, map_type->map_type.value);
+}
+
+static Type *check_subscript(SemChecker *self, AstNode *node) {
+    AstNode *expr = node->subscript.expr;
+    AstNode *left = node->subscript.left;
 
     Type *left_type = check_expr(self, left);
 
     if (left_type->id == TYPE_ERROR) {
         return self->types->error_type;
+    } else if (left_type->id == TYPE_MAP) {
+        return check_map_subscript(self, node, left_type);
     } else if (left_type->id != TYPE_LIST && left_type->id != TYPE_STRING) {
         DiagnosticMessage dmsg = {
             .kind = DIAGNOSTIC_EXPR_NOT_INDEXABLE,
@@ -488,7 +517,92 @@ static Type *check_subscript(SemChecker *self, const AstNode *node) {
     }
 }
 
-static Type *check_expr(SemChecker *self, const AstNode *node) {
+static void check_slice_bound(SemChecker *self, AstNode *bound) {
+    if (!bound) {
+        return;
+    }
+
+    Type *type = check_expr(self, bound);
+
+    if (type->id != TYPE_ERROR && type->id != TYPE_INT) {
+        DiagnosticMessage dmsg = {
+            .src_info = bound->tok.src_info,
+            .kind = DIAGNOSTIC_BAD_INDEX_TYPE,
+            .bad_index_type.found = type
+        };
+
+        error(self, &dmsg);
+    }
+}
+
+/* A slice of a string or list is of the same type */
+static Type *check_slice(SemChecker *self, AstNode *node) {
+    AstNode *left = node->slice.left;
+    Type *left_type = check_expr(self, left);
+
+    if (left_type->id == TYPE_ERROR) {
+        return self->types->error_type;
+    } else if (left_type->id != TYPE_LIST && left_type->id != TYPE_STRING) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_EXPR_NOT_INDEXABLE,
+            .src_info = left->tok.src_info,
+            {0}
+        };
+
+        error(self, &dmsg);
+
+        return self->types->error_type;
+    }
+
+    check_slice_bound(self, node->slice.start);
+    check_slice_bound(self, node->slice.end);
+
+    return left_type;
+}
+
+/* The index of the field is its offset in the layout of the struct */
+static Type *check_field(SemChecker *self, AstNode *node) {
+    AstNode *left = node->field.left;
+    Symbol name = node->field.name->ident.name;
+    Type *type = check_expr(self, left);
+
+    if (type->id == TYPE_ERROR) {
+        return self->types->error_type;
+    } else if (type->id != TYPE_STRUCT) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_EXPECTED_STRUCT,
+            .src_info = left->tok.src_info,
+            .type_mismatch.found = type
+        };
+
+        error(self, &dmsg);
+
+        return self->types->error_type;
+    }
+
+    const StructField *fields = type->struct_type.fields.data;
+
+    for (size_t i = 0; i < type->struct_type.fields.len; ++i) {
+        if (fields[i].name == name) {
+            node->field.idx = (int) i;
+
+            return fields[i].type;
+        }
+    }
+
+    DiagnosticMessage dmsg = {
+        .kind = DIAGNOSTIC_NO_SUCH_FIELD,
+        .src_info = node->field.name->tok.src_info,
+        .no_field.type = type,
+        .no_field.name = name
+    };
+
+    error(self, &dmsg);
+
+    return self->types->error_type;
+}
+
+static Type *check_expr_type(SemChecker *self, AstNode *node) {
     switch (node->kind) {
     case AST_NODE_INTEGER:
         return self->types->builtin_int;
@@ -510,12 +624,79 @@ static Type *check_expr(SemChecker *self, const AstNode *node) {
         return check_fn_call(self, node);
     case AST_NODE_SUBSCRIPT:
         return check_subscript(self, node);
+    case AST_NODE_SLICE:
+        return check_slice(self, node);
+    case AST_NODE_FIELD:
+        return check_field(self, node);
     default:
         return self->types->error_type;
     }
 }
 
-static Type *parse_type(SemChecker *self, const AstNode *node) {
+static Type *check_expr(SemChecker *self, AstNode *node) {
+    /* Kept for the optimizer */
+    node->type = check_expr_type(self, node);
+
+    return node->type;
+}
+
+static Type *parse_type(SemChecker *self, AstNode *node);
+
+static Type *resolve_map_type(SemChecker *self, AstNode *node) {
+    Type *key_type = parse_type(self, node->map_type.key);
+    Type *value_type = parse_type(self, node->map_type.value);
+
+    if (key_type->id != TYPE_INT && key_type->id != TYPE_STRING) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_BAD_MAP_KEY_TYPE,
+            .src_info = node->map_type.key->tok.src_info,
+            .bad_index_type.found = key_type
+        };
+
+        error(self, &dmsg);
+
+        return self->types->error_type;
+    }
+
+    if (value_type->id == TYPE_VOID) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_VOID_MAP_VALUE,
+            .src_info = node->map_type.value->tok.src_info,
+            {0}
+        };
+
+        error(self, &dmsg);
+
+        return self->types->error_type;
+    }
+
+    if (value_type->id == TYPE_ERROR) {
+        return self->types->error_type;
+    }
+
+    return type_system_map(self->types, key_type, value_type);
+}
+
+static Type *resolve_struct_type(SemChecker *self, AstNode *node) {
+    Symbol name = node->struct_type.name;
+    Type *type = type_system_get(self->types, name);
+
+    if (!type || type->id != TYPE_STRUCT) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_UNKNOWN_TYPE,
+            .src_info = node->tok.src_info,
+            .undef_sym.name = name
+        };
+
+        error(self, &dmsg);
+
+        return self->types->error_type;
+    }
+
+    return type;
+}
+
+static Type *resolve_type(SemChecker *self, AstNode *node) {
     switch (node->kind) {
     case AST_NODE_INT_TYPE:
         return self->types->builtin_int;
@@ -525,18 +706,18 @@ static Type *parse_type(SemChecker *self, const AstNode *node) {
         return self->types->builtin_void;
     case AST_NODE_LIST_TYPE: {
         Type *contained_type = parse_type(self, node->list_type.type);
-        Type list = {TYPE_LIST, NULL, {0}};
-        list.list_type.type = contained_type;
 
-        return type_system_register(self->types, &list);
+        return type_system_list(self->types, contained_type);
     }
     case AST_NODE_OPTION_TYPE: {
         Type *contained_type = parse_type(self, node->opt_type.type);
-        Type option = {TYPE_OPTION, NULL, {0}};
-        option.opt_type.type = contained_type;
 
-        return type_system_register(self->types, &option);
+        return type_system_option(self->types, contained_type);
     }
+    case AST_NODE_MAP_TYPE:
+        return resolve_map_type(self, node);
+    case AST_NODE_STRUCT_TYPE:
+        return resolve_struct_type(self, node);
     case AST_NODE_NIL:
         return self->types->nil_type;
     default:
@@ -544,7 +725,29 @@ static Type *parse_type(SemChecker *self, const AstNode *node) {
     }
 }
 
-static void check_var_decl(SemChecker *self, const AstNode *node) {
+/* The resolved type is also stored in the node for the compiler */
+static Type *parse_type(SemChecker *self, AstNode *node) {
+    node->type = resolve_type(self, node);
+
+    return node->type;
+}
+
+/* Depth of variables declared in the current scope */
+static int local_depth(const SemChecker *self) {
+    if (self->env.curr_scope == self->env.global_scope) {
+        return VAR_GLOBAL_DEPTH;
+    }
+
+    return (int) (self->env.scopes.len - 1 - self->env.frame_base);
+}
+
+/* Store the address of a variable declared in the current scope */
+static void set_var_address(SemChecker *self, AstNode *ident, Variable *var) {
+    ident->ident.depth = local_depth(self);
+    ident->ident.slot = var->slot;
+}
+
+static void check_var_decl(SemChecker *self, AstNode *node) {
     Type *type = parse_type(self, node->var_decl.type);
     AstNode *list_size_node = node->var_decl.type->list_type.size;
 
@@ -570,8 +773,8 @@ static void check_var_decl(SemChecker *self, const AstNode *node) {
         error(self, &dmsg);
     }
 
-    const char *name = node->var_decl.name->ident.str.data;
-    const AstNode *rvalue = node->var_decl.rvalue;
+    Symbol name = node->var_decl.name->ident.name;
+    AstNode *rvalue = node->var_decl.rvalue;
 
     if (rvalue) {
         Type *value_type = check_expr(self, rvalue);
@@ -592,15 +795,16 @@ static void check_var_decl(SemChecker *self, const AstNode *node) {
     Variable *var = mem_alloc(sizeof(*var));
 
     var->type = type;
-    var->name = cstr_dup(name);
+    var->name = name;
     var->is_param = false;
 
     env_add_local_var(&self->env, var);
+    set_var_address(self, node->var_decl.name, var);
 }
 
-static void check_node(SemChecker *self, const AstNode *node);
+static void check_node(SemChecker *self, AstNode *node);
 
-static void check_fn_decl(SemChecker *self, const AstNode *node) {
+static void check_fn_decl(SemChecker *self, AstNode *node) {
     if (self->env.curr_fn) {
         DiagnosticMessage dmsg = {
             .kind = DIAGNOSTIC_FN_BAD_PLACE,
@@ -614,10 +818,10 @@ static void check_fn_decl(SemChecker *self, const AstNode *node) {
     }
 
     Type *type = parse_type(self, node->fn_decl.type);
-    char *name = node->fn_decl.name->ident.str.data;
+    Symbol name = node->fn_decl.name->ident.name;
     AstNode *body = node->fn_decl.body;
 
-    if (hashmap_get(&self->env.funcs, name)) {
+    if (env_find_fn(&self->env, name)) {
         DiagnosticMessage dmsg = {
             .kind = DIAGNOSTIC_FN_REDEFINITION,
             .src_info = node->tok.src_info,
@@ -631,28 +835,29 @@ static void check_fn_decl(SemChecker *self, const AstNode *node) {
 
     Function *fn = mem_alloc(sizeof(*fn));
     fn->type = type;
-    fn->name = cstr_dup_n(name, node->fn_decl.name->ident.str.len);
-    fn->body = body;
-    fn->free_body = false;
+    fn->name = name;
 
     env_enter_scope(&self->env);
 
+    size_t saved_frame_base = self->env.frame_base;
+    self->env.frame_base = self->env.scopes.len - 1;
+
     vec_init(&fn->params, sizeof(FnParam));
 
     const Vector *params_vec = &node->fn_decl.params;
-    const AstNode **params = params_vec->data;
+    AstNode **params = params_vec->data;
 
     for (size_t i = 0; i < params_vec->len; ++i) {
-        const AstNode *param_node = params[i];
+        AstNode *param_node = params[i];
 
         type = parse_type(self, param_node->param_decl.type);
-        name = param_node->param_decl.name->ident.str.data;
+        name = param_node->param_decl.name->ident.name;
         bool bad_param = false;
 
         for (size_t j = 0; j < fn->params.len; ++j) {
             const FnParam *param = fn->params.data;
 
-            if (strcmp(name, param[j].name) == 0) {
+            if (name == param[j].name) {
                 DiagnosticMessage dmsg = {
                     .kind = DIAGNOSTIC_PARAM_REDECLARATION,
                     .src_info = param_node->tok.src_info,
@@ -668,14 +873,15 @@ static void check_fn_decl(SemChecker *self, const AstNode *node) {
         if (!bad_param) {
             FnParam *param = vec_emplace(&fn->params);
             param->type = type;
-            param->name = cstr_dup(name);
+            param->name = name;
 
             Variable *var = mem_alloc(sizeof(*var));
             var->type = type;
-            var->name = cstr_dup(name);
+            var->name = name;
             var->is_param = true;
 
             env_add_local_var(&self->env, var);
+            set_var_address(self, param_node->param_decl.name, var);
         } else {
             bad_param = false;
         }
@@ -690,11 +896,107 @@ static void check_fn_decl(SemChecker *self, const AstNode *node) {
     }
 
     env_leave_scope(&self->env);
+    self->env.frame_base = saved_frame_base;
+}
+
+/* Returns false if the field can't be added to the struct */
+static bool check_struct_field(SemChecker *self, Type *type, AstNode *field) {
+    Type *field_type = parse_type(self, field->param_decl.type);
+    Symbol name = field->param_decl.name->ident.name;
+    const StructField *fields = type->struct_type.fields.data;
+
+    for (size_t i = 0; i < type->struct_type.fields.len; ++i) {
+        if (fields[i].name == name) {
+            DiagnosticMessage dmsg = {
+                .kind = DIAGNOSTIC_FIELD_REDECLARATION,
+                .src_info = field->param_decl.name->tok.src_info,
+                .field_redecl.name = name
+            };
+
+            error(self, &dmsg);
+
+            return false;
+        }
+    }
+
+    if (field_type->id == TYPE_VOID) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_VOID_FIELD,
+            .src_info = field->tok.src_info,
+            {0}
+        };
+
+        error(self, &dmsg);
+
+        return false;
+    }
+
+    /* It would have to be created along with the struct itself, endlessly.
+     * Options and lists of it are fine, as they start empty. */
+    if (field_type == type) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_RECURSIVE_STRUCT,
+            .src_info = field->tok.src_info,
+            .struct_def.name = type->struct_type.name
+        };
+
+        error(self, &dmsg);
+
+        return false;
+    }
+
+    return field_type->id != TYPE_ERROR;
 }
 
-static void check_block(SemChecker *self, const AstNode *node) {
+/*
+ * The struct is registered before its fields are resolved, so they can refer
+ * to it. The fields are laid out in the order of declaration.
+ */
+static void check_struct_decl(SemChecker *self, AstNode *node) {
+    Symbol name = node->struct_decl.name->ident.name;
+
+    if (self->env.curr_scope != self->env.global_scope) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_STRUCT_BAD_PLACE,
+            .src_info = node->tok.src_info,
+            {0}
+        };
+
+        error(self, &dmsg);
+
+        return;
+    }
+
+    Type *type = type_system_struct(self->types, name);
+
+    if (!type) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_STRUCT_REDEFINITION,
+            .src_info = node->struct_decl.name->tok.src_info,
+            .struct_def.name = name
+        };
+
+        error(self, &dmsg);
+
+        return;
+    }
+
+    AstNode **fields = node->struct_decl.fields.data;
+
+    for (size_t i = 0; i < node->struct_decl.fields.len; ++i) {
+        AstNode *field = fields[i];
+
+        if (check_struct_field(self, type, field)) {
+            StructField *new_field = vec_emplace(&type->struct_type.fields);
+            new_field->name = field->param_decl.name->ident.name;
+            new_field->type = field->param_decl.type->type;
+        }
+    }
+}
+
+static void check_block(SemChecker *self, AstNode *node) {
     env_enter_scope(&self->env);
-    const AstNode **nodes = node->block.nodes.data;
+    AstNode **nodes = node->block.nodes.data;
 
     for (size_t i = 0; i < node->block.nodes.len; ++i) {
         check_node(self, nodes[i]);
@@ -703,11 +1005,9 @@ static void check_block(SemChecker *self, const AstNode *node) {
     env_leave_scope(&self->env);
 }
 
-static void check_if(SemChecker *self, const AstNode *node) {
-    const AstNode *cond = node->kw_if.cond;
-    const AstNode *body = node->kw_if.body;
-    const AstNode *else_body = node->kw_if.else_body;
-
+/* Conditions are compiled as branches, so they must be plain ints: && and
+ * || in them jump on each int operand instead of producing a value */
+static void check_cond(SemChecker *self, AstNode *cond) {
     Type *cond_type = check_expr(self, cond);
 
     if (cond_type->id != TYPE_ERROR && cond_type->id != TYPE_INT) {
@@ -720,6 +1020,14 @@ static void check_if(SemChecker *self, const AstNode *node) {
 
         error(self, &dmsg);
     }
+}
+
+static void check_if(SemChecker *self, AstNode *node) {
+    AstNode *cond = node->kw_if.cond;
+    AstNode *body = node->kw_if.body;
+    AstNode *else_body = node->kw_if.else_body;
+
+    check_cond(self, cond);
 
     if (body) {
         check_node(self, body);
@@ -730,22 +1038,11 @@ static void check_if(SemChecker *self, const AstNode *node) {
     }
 }
 
-static void check_while(SemChecker *self, const AstNode *node) {
-    const AstNode *cond = node->kw_while.cond;
-    const AstNode *body = node->kw_while.body;
+static void check_while(SemChecker *self, AstNode *node) {
+    AstNode *cond = node->kw_while.cond;
+    AstNode *body = node->kw_while.body;
 
-    Type *cond_type = check_expr(self, cond);
-
-    if (cond_type->id != TYPE_ERROR && cond_type->id != TYPE_INT) {
-        DiagnosticMessage dmsg = {
-            .kind = DIAGNOSTIC_MISMATCHED_TYPES,
-            .src_info = cond->tok.src_info,
-            .type_mismatch.expected = self->types->builtin_int,
-            .type_mismatch.found = cond_type,
-        };
-
-        error(self, &dmsg);
-    }
+    check_cond(self, cond);
 
     if (body) {
         ++self->loop_depth;
@@ -754,29 +1051,21 @@ static void check_while(SemChecker *self, const AstNode *node) {
     }
 }
 
-static void check_for(SemChecker *self, const AstNode *node) {
-    const AstNode *init = node->kw_for.init;
-    const AstNode *cond = node->kw_for.cond;
-    const AstNode *iter = node->kw_for.iter;
-    const AstNode *body = node->kw_for.body;
+static void check_for(SemChecker *self, AstNode *node) {
+    AstNode *init = node->kw_for.init;
+    AstNode *cond = node->kw_for.cond;
+    AstNode *iter = node->kw_for.iter;
+    AstNode *body = node->kw_for.body;
+
+    /* The variable declared in init lives in its own scope */
+    env_enter_scope(&self->env);
 
     if (init) {
         check_node(self, init);
     }
 
     if (cond) {
-        Type *cond_type = check_expr(self, cond);
-
-        if (cond_type->id != TYPE_ERROR && cond_type->id != TYPE_INT) {
-            DiagnosticMessage dmsg = {
-                .kind = DIAGNOSTIC_MISMATCHED_TYPES,
-                .src_info = cond->tok.src_info,
-                .type_mismatch.expected = self->types->builtin_int,
-                .type_mismatch.found = cond_type
-            };
-
-            error(self, &dmsg);
-        }
+        check_cond(self, cond);
     }
 
     if (iter) {
@@ -788,10 +1077,87 @@ static void check_for(SemChecker *self, const AstNode *node) {
         check_node(self, body);
         --self->loop_depth;
     }
+
+    env_leave_scope(&self->env);
+}
+
+static Variable *add_local_var(SemChecker *self, Type *type, Symbol name) {
+    Variable *var = mem_alloc(sizeof(*var));
+
+    var->type = type;
+    var->name = name;
+    var->is_param = false;
+
+    env_add_local_var(&self->env, var);
+
+    return var;
+}
+
+/*
+ * The keys are visited through hidden variables: a list of them, taken before
+ * the loop, and the index in it.
+ */
+static void check_for_each(SemChecker *self, AstNode *node) {
+    AstNode *var_node = node->kw_for_each.var;
+    AstNode *map = node->kw_for_each.map;
+    AstNode *body = node->kw_for_each.body;
+
+    Type *map_type = check_expr(self, map);
+    Type *key_type = parse_type(self, var_node->param_decl.type);
+
+    if (map_type->id != TYPE_ERROR && map_type->id != TYPE_MAP) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_EXPECTED_MAP,
+            .src_info = map->tok.src_info,
+            .type_mismatch.found = map_type
+        };
+
+        error(self, &dmsg);
+    } else if (map_type->id == TYPE_MAP && key_type->id != TYPE_ERROR &&
+               !type_equal(key_type, map_type->map_type.key)) {
+        DiagnosticMessage dmsg = {
+            .kind = DIAGNOSTIC_MISMATCHED_TYPES,
+            .src_info = var_node->tok.src_info,
+            .type_mismatch.expected = map_type->map_type.key,
+            .type_mismatch.found = key_type
+        };
+
+        error(self, &dmsg);
+    }
+
+    env_enter_scope(&self->env);
+
+    Variable *keys = add_local_var(
+        self, type_system_list(self->types, key_type),
+        sym_intern_cstr(AST_FOR_EACH_KEYS)
+    );
+    add_local_var(
+        self, self->types->builtin_int, sym_intern_cstr(AST_FOR_EACH_INDEX)
+    );
+
+    node->kw_for_each.depth = local_depth(self);
+    node->kw_for_each.slot = keys->slot;
+
+    /* The key variable is declared anew in every iteration */
+    env_enter_scope(&self->env);
+
+    Variable *var = add_local_var(
+        self, key_type, var_node->param_decl.name->ident.name
+    );
+    set_var_address(self, var_node->param_decl.name, var);
+
+    if (body) {
+        ++self->loop_depth;
+        check_node(self, body);
+        --self->loop_depth;
+    }
+
+    env_leave_scope(&self->env);
+    env_leave_scope(&self->env);
 }
 
-static void check_return(SemChecker *self, const AstNode *node) {
-    const AstNode *expr = node->kw_return.expr;
+static void check_return(SemChecker *self, AstNode *node) {
+    AstNode *expr = node->kw_return.expr;
 
     if (!self->env.curr_fn) {
         DiagnosticMessage dmsg = {
@@ -833,7 +1199,7 @@ static void check_return(SemChecker *self, const AstNode *node) {
     }
 }
 
-static void check_node(SemChecker *self, const AstNode *node) {
+static void check_node(SemChecker *self, AstNode *node) {
     switch (node->kind) {
     case AST_NODE_VAR_DECL:
         check_var_decl(self, node);
@@ -842,6 +1208,10 @@ static void check_node(SemChecker *self, const AstNode *node) {
     case AST_NODE_FN_DECL:
         check_fn_decl(self, node);
 
+        break;
+    case AST_NODE_STRUCT_DECL:
+        check_struct_decl(self, node);
+
         break;
     case AST_NODE_BLOCK:
         check_block(self, node);
@@ -858,6 +1228,10 @@ static void check_node(SemChecker *self, const AstNode *node) {
     case AST_NODE_FOR:
         check_for(self, node);
 
+        break;
+    case AST_NODE_FOR_EACH:
+        check_for_each(self, node);
+
         break;
     case AST_NODE_BREAK:
         if (self->loop_depth <= 0) {
@@ -913,7 +1287,8 @@ void semck_deinit(SemChecker *self) {
 static Variable *var_clone(const Variable *var) {
     Variable *var_copy = mem_alloc(sizeof(*var));
     var_copy->type = var->type;
-    var_copy->name = cstr_dup(var->name);
+    var_copy->name = var->name;
+    var_copy->slot = var->slot;
     var_copy->is_param = var->is_param;
 
     return var_copy;
@@ -926,16 +1301,12 @@ static void clone_fn_params(Vector *self, const Vector *params_vec) {
         FnParam *param = vec_emplace(self);
 
         param->type = params[i].type;
-
-        /* only builtin functions don't have names for params */
-        if (params[i].name) {
-            param->name = cstr_dup(params[i].name);
-        }
+        param->name = params[i].name;
     }
 }
 
 bool semck_check(
-    SemChecker *self, const Ast *ast, HashMap *vars, HashMap *funcs
+    SemChecker *self, Ast *ast, HashMap *vars, HashMap *funcs
 ) {
     if (vars) {
         for (HashMapIter it = hashmap_iter(vars); it.bucket != NULL;
@@ -956,16 +1327,14 @@ bool semck_check(
             vec_init(&fn_copy->params, sizeof(FnParam));
 
             fn_copy->type = fn->type;
-            fn_copy->name = cstr_dup(fn->name);
+            fn_copy->name = fn->name;
             clone_fn_params(&fn_copy->params, &fn->params);
-            fn_copy->body = fn->body;
-            fn_copy->free_body = false;
 
             env_add_fn(&self->env, fn_copy);
         }
     }
 
-    const AstNode **nodes = ast->nodes.data;
+    AstNode **nodes = ast->nodes.data;
 
     for (size_t i = 0; i < ast->nodes.len; ++i) {
         check_node(self, nodes[i]);
@@ -12,18 +12,53 @@
 #include <stdlib.h>
 #include <string.h>
 
+static void set_len(StrBuf *self, size_t len) {
+    if (str_is_inline(self)) {
+        self->cap = len;
+    } else {
+        self->heap.len = len;
+    }
+}
+
+/* Grow the capacity at least to min_cap, doubling it to make appends cheap */
+static bool grow(StrBuf *self, size_t min_cap) {
+    size_t new_cap = str_cap(self) * 2;
+
+    if (new_cap < min_cap) {
+        new_cap = min_cap;
+    }
+
+    return str_reserve(self, new_cap);
+}
+
 bool str_init(StrBuf *self) { return str_init_n(self, 0); }
 
-bool str_init_n(StrBuf *self, size_t len) {
-    self->data = mem_alloc(len + 1);
+/* Make room for len characters, contents are left unset */
+static bool alloc_data(StrBuf *self, size_t len) {
+    if (len <= STRBUF_SSO_CAP) {
+        self->cap = len;
+
+        return true;
+    }
 
-    if (!self->data) {
+    self->heap.data = mem_alloc(len + 1);
+
+    if (!self->heap.data) {
         return false;
     }
 
-    memset(self->data, 0, len + 1);
+    self->heap.len = len;
+    self->cap = len;
 
-    self->len = len;
+    return true;
+}
+
+bool str_init_n(StrBuf *self, size_t len) {
+    if (!alloc_data(self, len)) {
+        return false;
+    }
+
+    memset(str_data(self), 0, len + 1);
 
     return true;
 }
@@ -33,91 +68,145 @@ bool str_dup(StrBuf *self, const char *cstr) {
 }
 
 bool str_dup_n(StrBuf *self, const char *cstr, size_t len) {
-    self->data = mem_alloc(len + 1);
-
-    if (!self->data) {
+    if (!alloc_data(self, len)) {
         return false;
     }
 
-    memcpy(self->data, cstr, len);
-    self->data[len] = 0;
-
-    self->len = len;
+    char *data = str_data(self);
+    memcpy(data, cstr, len);
+    data[len] = '\0';
 
-    return self;
+    return true;
 }
 
 void str_deinit(StrBuf *self) {
-    free(self->data);
-    self->data = NULL;
-    self->len = 0;
+    if (!str_is_inline(self)) {
+        free(self->heap.data);
+    }
+
+    self->sso[0] = '\0';
+    self->cap = 0;
 }
 
 bool str_cat(StrBuf *self, const StrBuf *src) {
-    size_t new_len = self->len + src->len;
-    self->data = mem_realloc(self->data, new_len + 1);
+    size_t len = str_len(self);
+    size_t src_len = str_len(src);
+    size_t new_len = len + src_len;
 
-    if (!self->data) {
+    if (new_len > str_cap(self) && !grow(self, new_len)) {
         return false;
     }
 
-    memcpy(self->data + self->len, src->data, src->len);
-    self->data[new_len] = '\0';
+    /* src may be self, so its data is fetched after growing */
+    char *data = str_data(self);
+    memcpy(data + len, str_data(src), src_len);
+    data[new_len] = '\0';
 
-    self->len = new_len;
+    set_len(self, new_len);
 
     return true;
 }
 
 bool str_set_cstr(StrBuf *self, const char *cstr) {
-    if (!self->data) {
-        return str_dup(self, cstr);
+    size_t cstr_len = strlen(cstr);
+
+    if (!str_reserve(self, cstr_len)) {
+        return false;
     }
 
-    size_t cstr_len = strlen(cstr);
+    memcpy(str_data(self), cstr, cstr_len + 1);
+    set_len(self, cstr_len);
+
+    return true;
+}
 
-    if (cstr_len > self->len) {
-        size_t diff = cstr_len - self->len;
+bool str_equal(const StrBuf *self, const StrBuf *str) {
+    size_t len = str_len(self);
 
-        self->data = mem_realloc(self->data, self->len + diff + 1);
+    if (len != str_len(str)) {
+        return false;
+    }
+
+    return strncmp(str_data(self), str_data(str), len) == 0;
+}
 
-        if (!self->data) {
+/* Change the length to n. New characters are set to zero. */
+bool str_resize(StrBuf *self, size_t n) {
+    size_t len = str_len(self);
+
+    if (n <= len) {
+        str_data(self)[n] = '\0';
+        set_len(self, n);
+
+        return true;
+    }
+
+    if (n > str_cap(self) && !grow(self, n)) {
+        return false;
+    }
+
+    memset(str_data(self) + len, 0, n - len + 1);
+    set_len(self, n);
+
+    return true;
+}
+
+/* Make room for at least cap characters without changing the contents */
+bool str_reserve(StrBuf *self, size_t cap) {
+    if (cap <= str_cap(self)) {
+        return true;
+    }
+
+    if (str_is_inline(self)) {
+        size_t len = self->cap;
+        char *data = mem_alloc(cap + 1);
+
+        if (!data) {
             return false;
         }
 
-        self->len += diff;
+        memcpy(data, self->sso, len + 1);
+        self->heap.data = data;
+        self->heap.len = len;
     } else {
-        self->len = cstr_len;
+        self->heap.data = mem_realloc(self->heap.data, cap + 1);
+
+        if (!self->heap.data) {
+            return false;
+        }
     }
 
-    memcpy(self->data, cstr, self->len + 1);
+    self->cap = cap;
 
     return true;
 }
 
-bool str_equal(const StrBuf *self, const StrBuf *str) {
-    if (self->len != str->len) {
-        return false;
+/* Release the memory not used by the contents */
+bool str_shrink(StrBuf *self) {
+    if (str_is_inline(self) || self->cap == self->heap.len) {
+        return true;
     }
 
-    return strncmp(self->data, str->data, self->len) == 0;
-}
+    size_t len = self->heap.len;
+
+    if (len <= STRBUF_SSO_CAP) {
+        char *data = self->heap.data;
+
+        memcpy(self->sso, data, len + 1);
+        free(data);
+
+        self->cap = len;
 
-bool str_resize(StrBuf *self, size_t n) {
-    /* this function does not support shrink for now, because it was not needed.
-     */
-    if (n <= self->len) {
         return true;
     }
 
-    self->data = mem_realloc(self->data, n + 1);
+    self->heap.data = mem_realloc(self->heap.data, len + 1);
 
-    if (!self->data) {
+    if (!self->heap.data) {
         return false;
     }
 
-    memset(self->data + self->len, 0, n - self->len + 1);
-    self->len = n;
+    self->cap = len;
 
     return true;
 }
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/arena.h>
+#include <monolog/symbol.h>
+#include <monolog/utils.h>
+#include <monolog/vector.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SYM_TABLE_DEFAULT_CAP 256
+
+/*
+ * Open addressing with linear probing, keyed by a string of a given length,
+ * so identifiers can be interned straight from the source.
+ * Short names are stored in an arena, longer ones are allocated separately.
+ */
+typedef struct SymTable {
+    Symbol *syms;
+    size_t size;
+    size_t cap;
+    Arena names;
+    Vector long_names; /* Vector<SymHeader *> */
+} SymTable;
+
+static SymTable g_table;
+
+static Symbol *find_entry(
+    Symbol *syms, size_t cap, const char *str, size_t len, HashType hash
+) {
+    size_t idx = hash & (cap - 1);
+
+    for (;;) {
+        Symbol *sym = &syms[idx];
+
+        if (!*sym || (sym_hash(*sym) == hash && sym_len(*sym) == len &&
+                      memcmp(*sym, str, len) == 0)) {
+            return sym;
+        }
+
+        idx = (idx + 1) & (cap - 1);
+    }
+}
+
+static void grow(SymTable *self) {
+    size_t new_cap = self->cap ? self->cap * 2 : SYM_TABLE_DEFAULT_CAP;
+    Symbol *new_syms = mem_alloc(new_cap * sizeof(Symbol));
+
+    for (size_t i = 0; i < self->cap; ++i) {
+        Symbol sym = self->syms[i];
+
+        if (sym) {
+            *find_entry(new_syms, new_cap, sym, sym_len(sym), sym_hash(sym)) =
+                sym;
+        }
+    }
+
+    free(self->syms);
+    self->syms = new_syms;
+    self->cap = new_cap;
+}
+
+static Symbol
+store_name(SymTable *self, const char *str, size_t len, HashType hash) {
+    size_t size = sizeof(SymHeader) + len + 1;
+    SymHeader *header;
+
+    if (size <= ARENA_MAX_SIZE) {
+        header = arena_alloc(&self->names, size);
+    } else {
+        if (!self->long_names.data) {
+            vec_init(&self->long_names, sizeof(SymHeader *));
+        }
+
+        header = mem_alloc(size);
+        vec_push(&self->long_names, &header);
+    }
+
+    header->hash = hash;
+    header->len = (uint32_t) len;
+
+    char *name = (char *) (header + 1);
+    memcpy(name, str, len);
+    name[len] = '\0';
+
+    return name;
+}
+
+Symbol sym_intern(const char *str, size_t len) {
+    SymTable *self = &g_table;
+
+    /* Keep the load factor under 1/2 */
+    if (self->size * 2 >= self->cap) {
+        grow(self);
+    }
+
+    HashType hash = hashmap_hash(str, len);
+    Symbol *sym = find_entry(self->syms, self->cap, str, len, hash);
+
+    if (!*sym) {
+        *sym = store_name(self, str, len, hash);
+
+        ++self->size;
+    }
+
+    return *sym;
+}
+
+Symbol sym_intern_cstr(const char *str) { return sym_intern(str, strlen(str)); }
+
+void sym_table_deinit(void) {
+    SymTable *self = &g_table;
+    SymHeader **long_names = self->long_names.data;
+
+    for (size_t i = 0; i < self->long_names.len; ++i) {
+        free(long_names[i]);
+    }
+
+    vec_deinit(&self->long_names);
+    arena_deinit(&self->names);
+    free(self->syms);
+
+    memset(self, 0, sizeof(*self));
+}
@@ -45,6 +45,20 @@ void format_type_name(const Type *type, int *pos) {
         format_type_name(type->list_type.type, pos);
         *pos += snprintf(g_buf + *pos, BUF_SIZE - (size_t)*pos, ">");
 
+        break;
+    case TYPE_MAP:
+        *pos += snprintf(g_buf + *pos, BUF_SIZE - (size_t)*pos, "map<");
+        format_type_name(type->map_type.key, pos);
+        *pos += snprintf(g_buf + *pos, BUF_SIZE - (size_t)*pos, ", ");
+        format_type_name(type->map_type.value, pos);
+        *pos += snprintf(g_buf + *pos, BUF_SIZE - (size_t)*pos, ">");
+
+        break;
+    case TYPE_STRUCT:
+        *pos += snprintf(
+            g_buf + *pos, BUF_SIZE - (size_t)*pos, "%s", type->struct_type.name
+        );
+
         break;
     case TYPE_ERROR:
         *pos += snprintf(g_buf + *pos, BUF_SIZE - (size_t)*pos, "<error>");
@@ -86,22 +100,22 @@ void type_system_init(TypeSystem *self) {
     hashmap_init(&self->types);
     vec_init(&self->type_names, sizeof(char *));
 
-    Type builtin_int = {TYPE_INT, NULL, {0}};
+    Type builtin_int = {.id = TYPE_INT};
     self->builtin_int = type_system_register(self, &builtin_int);
 
-    Type builtin_string = {TYPE_STRING, NULL, {0}};
+    Type builtin_string = {.id = TYPE_STRING};
     self->builtin_string = type_system_register(self, &builtin_string);
 
-    Type builtin_void = {TYPE_VOID, NULL, {0}};
+    Type builtin_void = {.id = TYPE_VOID};
     self->builtin_void = type_system_register(self, &builtin_void);
 
-    Type opt_type = {TYPE_OPTION, NULL, {0}};
+    Type opt_type = {.id = TYPE_OPTION};
     self->opt_type = type_system_register(self, &opt_type);
 
-    Type error_type = {TYPE_ERROR, NULL, {0}};
+    Type error_type = {.id = TYPE_ERROR};
     self->error_type = type_system_register(self, &error_type);
 
-    Type nil_type = {TYPE_NIL, NULL, {0}};
+    Type nil_type = {.id = TYPE_NIL};
     self->nil_type = type_system_register(self, &nil_type);
 }
 
@@ -118,6 +132,12 @@ void type_system_deinit(TypeSystem *self) {
          hashmap_iter_next(&it)) {
         Type *type = it.bucket->value;
 
+        if (type->id == TYPE_OPTION) {
+            free(type->opt_type.empty);
+        } else if (type->id == TYPE_STRUCT) {
+            vec_deinit(&type->struct_type.fields);
+        }
+
         free(type->name);
         type->name = NULL;
 
@@ -153,12 +173,66 @@ Type *type_system_register(TypeSystem *self, const Type *type) {
         memcpy(new_type, type, sizeof(*new_type));
         new_type->name = name;
 
+        if (new_type->id == TYPE_OPTION) {
+            Type *empty = mem_alloc(sizeof(*empty));
+            memcpy(empty, new_type, sizeof(*empty));
+
+            new_type->opt_type.present = new_type;
+            new_type->opt_type.empty = empty;
+            empty->opt_type.present = new_type;
+            empty->opt_type.empty = empty;
+        }
+
         hashmap_add(&self->types, name, new_type);
 
         return new_type;
     }
 }
 
+Type *type_system_list(TypeSystem *self, Type *type) {
+    if (!type->list_of) {
+        Type list = {.id = TYPE_LIST};
+        list.list_type.type = type;
+
+        type->list_of = type_system_register(self, &list);
+    }
+
+    return type->list_of;
+}
+
+Type *type_system_option(TypeSystem *self, Type *type) {
+    if (!type->opt_of) {
+        Type option = {.id = TYPE_OPTION};
+        option.opt_type.type = type;
+
+        type->opt_of = type_system_register(self, &option);
+    }
+
+    return type->opt_of;
+}
+
+Type *type_system_map(TypeSystem *self, Type *key, Type *value) {
+    Type map = {.id = TYPE_MAP};
+    map.map_type.key = key;
+    map.map_type.value = value;
+
+    return type_system_register(self, &map);
+}
+
+Type *type_system_struct(TypeSystem *self, Symbol name) {
+    if (hashmap_get(&self->types, name)) {
+        return NULL;
+    }
+
+    Type type = {.id = TYPE_STRUCT};
+    type.struct_type.name = name;
+
+    Type *new_type = type_system_register(self, &type);
+    vec_init(&new_type->struct_type.fields, sizeof(StructField));
+
+    return new_type;
+}
+
 Type *type_system_get(TypeSystem *self, const char *name) {
     return hashmap_get(&self->types, name);
 }
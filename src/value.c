@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2025-present inunix3
+ *
+ * This file is licensed under the MIT License (Expat)
+ * (see LICENSE.md in the root of project).
+ */
+
+#include <monolog/rc.h>
+#include <monolog/utils.h>
+#include <monolog/value.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+_Static_assert(
+    sizeof(Value) == sizeof(Type *) + sizeof(Int),
+    "a value must consist only of its type and payload"
+);
+
+/* The viewed object is never a view itself, so slices of slices don't form
+ * chains */
+typedef struct StrSlice {
+    StrBuf str;
+    StrBuf *parent;
+} StrSlice;
+
+typedef struct ListSlice {
+    Vector list;
+    Vector *parent;
+} ListSlice;
+
+/* The reference counted object of the value, if it has one */
+static void *object(const Value *val) {
+    if (!val->type) {
+        return NULL;
+    }
+
+    switch (val->type->id) {
+    case TYPE_STRING:
+        return val->s;
+    case TYPE_LIST:
+        return val->list.values;
+    case TYPE_MAP:
+        return val->map;
+    case TYPE_STRUCT:
+        return val->fields;
+    case TYPE_OPTION: {
+        if (!value_opt_is_present(val)) {
+            return NULL;
+        }
+
+        if (value_opt_is_boxed(val->type)) {
+            return val->opt.val;
+        }
+
+        Value inner = value_opt_get(val);
+
+        return object(&inner);
+    }
+    default:
+        return NULL;
+    }
+}
+
+Value *value_new_box(Type *type) {
+    Value *box = rc_alloc(sizeof(*box));
+    box->type = type;
+
+    return box;
+}
+
+StrBuf *value_new_string(void) {
+    return rc_alloc(sizeof(StrBuf));
+}
+
+Vector *value_new_list(const Type *type) {
+    Vector *list = rc_alloc(sizeof(*list));
+    size_t elem_size = sizeof(Value);
+
+    if (value_list_is_unboxed(type)) {
+        elem_size = sizeof(Int);
+    } else if (value_list_is_inline(type)) {
+        elem_size = value_struct_len(type->list_type.type) * sizeof(Value);
+    }
+
+    vec_init(list, elem_size);
+
+    return list;
+}
+
+ValueMap *value_new_map(Type *type) {
+    ValueMap *map = rc_alloc(sizeof(*map));
+    map->type = type;
+    vec_init(&map->entries, sizeof(MapEntry *));
+
+    return map;
+}
+
+Value *value_new_struct(const Type *type) {
+    return rc_alloc(value_struct_len(type) * sizeof(Value));
+}
+
+StrBuf *value_new_string_slice(StrBuf *str, size_t start, size_t len) {
+    StrSlice *slice = rc_alloc(sizeof(*slice));
+    rc_make_view(slice);
+
+    /* Short slices are copied instead, so the view is never inline */
+    assert(len > STRBUF_SSO_CAP);
+
+    slice->str.heap.data = str_data(str) + start;
+    slice->str.heap.len = len;
+    slice->str.cap = len;
+
+    slice->parent = rc_is_view(str) ? ((StrSlice *) str)->parent : str;
+    rc_retain(slice->parent);
+
+    return &slice->str;
+}
+
+Vector *value_new_list_slice(Vector *list, size_t start, size_t len) {
+    ListSlice *slice = rc_alloc(sizeof(*slice));
+    rc_make_view(slice);
+
+    slice->list.data = (char *) list->data + start * list->element_size;
+    slice->list.len = len;
+    slice->list.cap = len;
+    slice->list.element_size = list->element_size;
+
+    slice->parent = rc_is_view(list) ? ((ListSlice *) list)->parent : list;
+    rc_retain(slice->parent);
+
+    return &slice->list;
+}
+
+void value_retain(const Value *val) {
+    void *obj = object(val);
+
+    if (obj) {
+        rc_retain(obj);
+    }
+}
+
+void value_release(const Value *val) {
+    if (!object(val)) {
+        return;
+    }
+
+    switch (val->type->id) {
+    case TYPE_STRING:
+        value_release_string(val->s);
+
+        break;
+    case TYPE_LIST:
+        value_release_list(val->list.values, val->type);
+
+        break;
+    case TYPE_MAP:
+        value_release_map(val->map);
+
+        break;
+    case TYPE_STRUCT:
+        value_release_struct(val->fields, val->type);
+
+        break;
+    case TYPE_OPTION:
+        if (value_opt_is_boxed(val->type)) {
+            value_release_box(val->opt.val);
+        } else {
+            Value inner = value_opt_get(val);
+            value_release(&inner);
+        }
+
+        break;
+    default:
+        break;
+    }
+}
+
+bool value_is_shared(const Value *val) {
+    void *obj = object(val);
+
+    return obj && (rc_shared(obj) || rc_is_view(obj));
+}
+
+/* The pin keeps the object alive, even if the aliased value drops it */
+void value_pin(const Value *val) {
+    void *obj = object(val);
+
+    if (obj) {
+        rc_retain(obj);
+        rc_pin(obj);
+    }
+}
+
+void value_unpin(const Value *val) {
+    void *obj = object(val);
+
+    if (obj) {
+        rc_unpin(obj);
+        value_release(val);
+    }
+}
+
+bool value_is_pinned(const Value *val) {
+    void *obj = object(val);
+
+    return obj && rc_pinned(obj);
+}
+
+void value_release_string(StrBuf *str) {
+    if (!rc_release(str)) {
+        return;
+    }
+
+    if (rc_is_view(str)) {
+        value_release_string(((StrSlice *) str)->parent);
+    } else {
+        str_deinit(str);
+    }
+
+    rc_free(str);
+}
+
+void value_release_list(Vector *list, const Type *type) {
+    if (!rc_release(list)) {
+        return;
+    }
+
+    /* the elements belong to the viewed list */
+    if (rc_is_view(list)) {
+        value_release_list(((ListSlice *) list)->parent, type);
+        rc_free(list);
+
+        return;
+    }
+
+    if (!value_list_is_unboxed(type)) {
+        const Value *values = list->data;
+        size_t len = list->len;
+
+        /* the fields of inline structs are values too */
+        if (value_list_is_inline(type)) {
+            len *= value_struct_len(type->list_type.type);
+        }
+
+        for (size_t i = 0; i < len; ++i) {
+            value_release(&values[i]);
+        }
+    }
+
+    vec_deinit(list);
+    rc_free(list);
+}
+
+void value_release_map(ValueMap *map) {
+    if (!rc_release(map)) {
+        return;
+    }
+
+    MapEntry **entries = map->entries.data;
+
+    for (size_t i = 0; i < map->entries.len; ++i) {
+        value_release(&entries[i]->key);
+        value_release(&entries[i]->val);
+        free(entries[i]);
+    }
+
+    vec_deinit(&map->entries);
+    hashmap_deinit(&map->index);
+    rc_free(map);
+}
+
+void value_release_struct(Value *fields, const Type *type) {
+    if (!rc_release(fields)) {
+        return;
+    }
+
+    for (size_t i = 0; i < value_struct_len(type); ++i) {
+        value_release(&fields[i]);
+    }
+
+    rc_free(fields);
+}
+
+void value_release_box(Value *box) {
+    if (rc_release(box)) {
+        value_release(box);
+        rc_free(box);
+    }
+}
+
+bool value_list_is_unboxed(const Type *type) {
+    return type->list_type.type->id == TYPE_INT;
+}
+
+bool value_list_is_inline(const Type *type) {
+    return type->list_type.type->id == TYPE_STRUCT;
+}
+
+size_t value_struct_len(const Type *type) {
+    return type->struct_type.fields.len;
+}
+
+bool value_opt_is_boxed(const Type *type) {
+    return type->opt_type.type->id == TYPE_OPTION;
+}
+
+bool value_opt_is_present(const Value *val) {
+    return val->type->id == TYPE_OPTION &&
+           val->type != val->type->opt_type.empty;
+}
+
+Value value_opt_get(const Value *val) {
+    assert(value_opt_is_present(val));
+
+    if (value_opt_is_boxed(val->type)) {
+        return *val->opt.val;
+    }
+
+    Value inner = *val;
+    inner.type = val->type->opt_type.type;
+
+    return inner;
+}
+
+/* The bytes the key is hashed and compared by */
+static const char *map_key_bytes(const Value *key, size_t *len) {
+    if (key->type->id == TYPE_STRING) {
+        *len = str_len(key->s);
+
+        return str_data(key->s);
+    }
+
+    *len = sizeof(key->i);
+
+    return (const char *) &key->i;
+}
+
+MapEntry *value_map_find(const ValueMap *map, const Value *key) {
+    size_t len;
+    const char *bytes = map_key_bytes(key, &len);
+
+    return hashmap_get_hashed(
+        &map->index, bytes, len, hashmap_hash(bytes, len)
+    );
+}
+
+MapEntry *value_map_add(ValueMap *map, const Value *key) {
+    if (!map->index.ctrl) {
+        hashmap_init_cap(&map->index, VALUE_MAP_MIN_CAP);
+    }
+
+    MapEntry *entry = mem_alloc(sizeof(*entry));
+    entry->key = *key;
+    entry->idx = map->entries.len;
+
+    /* The index refers to the key of the entry, which never moves */
+    size_t len;
+    const char *bytes = map_key_bytes(&entry->key, &len);
+
+    hashmap_add_hashed(
+        &map->index, bytes, len, hashmap_hash(bytes, len), entry
+    );
+    vec_push(&map->entries, &entry);
+
+    return entry;
+}
+
+/* The last entry takes the place of the removed one */
+void value_map_remove(ValueMap *map, MapEntry *entry) {
+    size_t len;
+    const char *bytes = map_key_bytes(&entry->key, &len);
+
+    hashmap_remove_hashed(&map->index, bytes, len, hashmap_hash(bytes, len));
+
+    MapEntry **entries = map->entries.data;
+    MapEntry *last = entries[map->entries.len - 1];
+
+    entries[entry->idx] = last;
+    last->idx = entry->idx;
+    vec_pop(&map->entries);
+
+    value_release(&entry->key);
+    value_release(&entry->val);
+    free(entry);
+}
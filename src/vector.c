@@ -91,3 +91,24 @@ void vec_clear(Vector *self) {
     memset(self->data, 0, self->cap * self->element_size);
     self->len = 0;
 }
+
+bool vec_reserve(Vector *self, size_t cap) {
+    if (cap <= self->cap) {
+        return true;
+    }
+
+    self->data = mem_realloc(self->data, cap * self->element_size);
+
+    if (!self->data) {
+        return false;
+    }
+
+    memset(
+        self->data + self->cap * self->element_size, 0,
+        (cap - self->cap) * self->element_size
+    );
+
+    self->cap = cap;
+
+    return true;
+}
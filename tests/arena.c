@@ -0,0 +1,108 @@
+#include <monolog/arena.h>
+
+#include <greatest.h>
+
+#include <stdint.h>
+
+static Arena g_arena;
+
+void set_up(void *udata) {
+    (void) udata;
+
+    arena_init(&g_arena);
+}
+
+void tear_down(void *udata) {
+    (void) udata;
+
+    arena_deinit(&g_arena);
+}
+
+TEST empty_arena(void) {
+    ASSERT_EQ(NULL, g_arena.chunks);
+    ASSERT_EQ(0, g_arena.stats.allocs);
+    ASSERT_EQ(0, g_arena.stats.chunks);
+
+    PASS();
+}
+
+TEST alloc_is_zeroed_and_aligned(void) {
+    for (size_t size = 1; size <= ARENA_MAX_SIZE; ++size) {
+        unsigned char *cell = arena_alloc(&g_arena, size);
+
+        ASSERT_EQ(0, (uintptr_t) cell % ARENA_ALIGN);
+
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(0, cell[i]);
+        }
+
+        memset(cell, 0xff, size);
+    }
+
+    ASSERT_EQ(ARENA_MAX_SIZE, g_arena.stats.allocs);
+    ASSERT_EQ(1, g_arena.stats.chunks);
+
+    PASS();
+}
+
+TEST reuse_freed_cell(void) {
+    char *a = arena_alloc(&g_arena, 40);
+    memset(a, 'a', 40);
+    arena_free(&g_arena, a, 40);
+
+    /* same size class */
+    char *b = arena_alloc(&g_arena, 33);
+
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(0, b[0]);
+    ASSERT_EQ(0, b[32]);
+
+    /* different size class */
+    arena_free(&g_arena, b, 33);
+    char *c = arena_alloc(&g_arena, 16);
+
+    ASSERT(c != a);
+    ASSERT_EQ(2, g_arena.stats.frees);
+    ASSERT_EQ(3, g_arena.stats.allocs);
+    ASSERT_EQ(48 + 48 + 16, g_arena.stats.bytes);
+
+    PASS();
+}
+
+TEST grow_chunks(void) {
+    size_t count = 3 * ARENA_CHUNK_SIZE / 64;
+    char *prev = NULL;
+
+    for (size_t i = 0; i < count; ++i) {
+        char *cell = arena_alloc(&g_arena, 64);
+
+        ASSERT(cell != prev);
+
+        prev = cell;
+    }
+
+    ASSERT(g_arena.stats.chunks >= 3);
+    ASSERT_EQ(count, g_arena.stats.allocs);
+
+    PASS();
+}
+
+SUITE(arena) {
+    GREATEST_SET_SETUP_CB(set_up, NULL);
+    GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
+
+    RUN_TEST(empty_arena);
+    RUN_TEST(alloc_is_zeroed_and_aligned);
+    RUN_TEST(reuse_freed_cell);
+    RUN_TEST(grow_chunks);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char *argv[]) {
+    GREATEST_MAIN_BEGIN();
+
+    RUN_SUITE(arena);
+
+    GREATEST_MAIN_END();
+}
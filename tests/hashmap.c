@@ -221,6 +221,73 @@ TEST capacity_remains_the_same_after_clearing(void) {
     PASS();
 }
 
+TEST precomputed_hash(void) {
+    const char *src = "TestKey TestKey2";
+    HashType hash = hashmap_hash(src, 7);
+
+    ASSERT(hashmap_add_hashed(&g_map, src, 7, hash, "Some value"));
+    ASSERT_EQ(1, g_map.size);
+
+    ASSERT_STR_EQ("Some value", hashmap_get(&g_map, "TestKey"));
+    ASSERT_STR_EQ("Some value", hashmap_get_hashed(&g_map, src, 7, hash));
+    ASSERT_EQ(NULL, hashmap_get(&g_map, "TestKey2"));
+
+    hashmap_remove_hashed(&g_map, "TestKey", 7, hash);
+
+    ASSERT_EQ(0, g_map.size);
+    ASSERT_EQ(NULL, hashmap_get(&g_map, "TestKey"));
+
+    PASS();
+}
+
+TEST reuse_deleted_buckets(void) {
+    TestData data[100] = {0};
+
+    for (int round = 0; round < 100; ++round) {
+        fill_test_data(data, 100);
+
+        ASSERT_EQ(100, g_map.size);
+
+        for (int i = 0; i < 100; ++i) {
+            int *value = hashmap_get(&g_map, data[i].buf);
+
+            ASSERT(value != NULL);
+            ASSERT_EQ(i, *value);
+
+            hashmap_remove(&g_map, data[i].buf);
+        }
+
+        ASSERT_EQ(0, g_map.size);
+    }
+
+    /* Deleted buckets are dropped instead of growing the map */
+    ASSERT_EQ(HASHMAP_DEFAULT_CAP, g_map.cap);
+
+    PASS();
+}
+
+TEST grow_from_small_capacity(void) {
+    TestData data[100] = {0};
+
+    hashmap_deinit(&g_map);
+    ASSERT(hashmap_init_cap(&g_map, HASHMAP_GROUP_WIDTH));
+    ASSERT_EQ(HASHMAP_GROUP_WIDTH, g_map.cap);
+
+    fill_test_data(data, 100);
+
+    ASSERT_EQ(100, g_map.size);
+    ASSERT_EQ(256, g_map.cap);
+
+    for (int i = 0; i < 100; ++i) {
+        int *value = hashmap_get(&g_map, data[i].buf);
+
+        ASSERT(value != NULL);
+        ASSERT_EQ(i, *value);
+    }
+
+    PASS();
+}
+
 SUITE(hashmap) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -235,6 +302,9 @@ SUITE(hashmap) {
     RUN_TEST(grow);
     RUN_TEST(capacity_remains_the_same_after_deleting_all);
     RUN_TEST(capacity_remains_the_same_after_clearing);
+    RUN_TEST(precomputed_hash);
+    RUN_TEST(reuse_deleted_buckets);
+    RUN_TEST(grow_from_small_capacity);
 }
 
 GREATEST_MAIN_DEFS();
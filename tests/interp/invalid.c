@@ -26,10 +26,64 @@ TEST mod_by_zero(void) {
     PASS();
 }
 
+TEST stack_overflow(void) {
+    g_interp.max_depth = 100;
+
+    run(
+        "int depth(int n) { if (n == 0) { return 0; } return depth(n - 1) + 1; }"
+        "int a = depth(99);"
+        "int b = depth(100);"
+    );
+
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+    ASSERT_EQ(0, g_interp.frames.len);
+    ASSERT_EQ(0, g_interp.pinned.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(-1, g_interp.exit_code);
+    ASSERT_EQ(true, g_interp.had_error);
+    ASSERT_EQ(true, g_interp.halt);
+
+    PASS();
+}
+
+TEST slice_out_of_range(void) {
+    Value v = eval("\"abc\"[2:4]");
+
+    ASSERT_EQ(TYPE_ERROR, v.type->id);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(-1, g_interp.exit_code);
+    ASSERT_EQ(true, g_interp.had_error);
+    ASSERT_EQ(true, g_interp.halt);
+
+    PASS();
+}
+
+TEST undeclared_inlinable_fn(void) {
+    run(
+        "int x = 1;"
+        "if (x == 0) { int f(int a) { return a + 1; } }"
+        "int y = f(1);"
+    );
+
+    ASSERT_EQ(0, g_optimizer.inlined);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(-1, g_interp.exit_code);
+    ASSERT_EQ(true, g_interp.had_error);
+    ASSERT_EQ(true, g_interp.halt);
+
+    PASS();
+}
+
 SUITE(invalid) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
 
     RUN_TEST(div_by_zero);
     RUN_TEST(mod_by_zero);
+    RUN_TEST(stack_overflow);
+    RUN_TEST(slice_out_of_range);
+    RUN_TEST(undeclared_inlinable_fn);
 }
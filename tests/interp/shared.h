@@ -3,7 +3,9 @@
 #include <monolog/diagnostic.h>
 #include <monolog/interp.h>
 #include <monolog/lexer.h>
+#include <monolog/optimizer.h>
 #include <monolog/parser.h>
+#include <monolog/rc.h>
 #include <monolog/semck.h>
 
 #include <greatest.h>
@@ -15,6 +17,7 @@ static Ast g_ast;
 static TypeSystem g_types;
 static SemChecker g_semck;
 static Interpreter g_interp;
+static Optimizer g_optimizer;
 
 static void set_up(void *udata) {
     (void)udata;
@@ -22,11 +25,13 @@ static void set_up(void *udata) {
     type_system_init(&g_types);
     semck_init(&g_semck, &g_types);
     interp_init(&g_interp, &g_ast, &g_types);
+    optimizer_init(&g_optimizer);
 }
 
 static void tear_down(void *udata) {
     (void)udata;
 
+    optimizer_deinit(&g_optimizer);
     interp_deinit(&g_interp);
     semck_deinit(&g_semck);
     type_system_deinit(&g_types);
@@ -46,11 +51,17 @@ static bool parse(const char *input) {
 
     semck_reset(&g_semck);
 
+    /* Inlined functions of the previous AST are gone */
+    optimizer_deinit(&g_optimizer);
+    optimizer_init(&g_optimizer);
+
     if (!parser.had_error &&
         semck_check(
             &g_semck, &g_ast, &g_interp.env.global_scope->vars,
             &g_interp.env.funcs
         )) {
+        optimizer_optimize(&g_optimizer, &g_ast);
+
         return true;
     } else {
         return false;
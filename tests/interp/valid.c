@@ -143,7 +143,7 @@ TEST binary_string_plus_string(void) {
     Value v = eval("\"Hello\" + \", \" + \"World\" + \"!\"");
 
     ASSERT_EQ(TYPE_STRING, v.type->id);
-    ASSERT_STR_EQ("Hello, World!", v.s->data);
+    ASSERT_STR_EQ("Hello, World!", str_data(v.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -545,6 +545,135 @@ TEST or_false(void) {
     PASS();
 }
 
+TEST short_circuit(void) {
+    run(
+        "int calls = 0;"
+        "int f(int x) { calls++; return x; }"
+        "[int] xs;"
+        "xs #= 3;"
+        "xs[1] = 5;"
+        "int i = 0;"
+        "while (i < #xs && xs[i] == 0) { i++; }"
+        "int j = 0;"
+        "for (j = 5; !(j < #xs) || xs[j] != 0; j--) {}"
+        "int a = 0 && f(1);"
+        "int b = 7 || f(1);"
+        "int c = 1 && f(9);"
+        "if (f(0) || f(1) && !f(0)) { a = a + 10; }"
+    );
+
+    Value v1 = eval("calls * 1000 + i * 100 + j * 10 + a");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(4130, v1.i);
+
+    Value v2 = eval("b * 10 + c");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(11, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST fold_constants(void) {
+    Value v1 = eval("60 * 60 * 24 + ord(\"A\")");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(86465, v1.i);
+    ASSERT_EQ(4, g_optimizer.folded);
+    ASSERT_EQ(AST_NODE_INTEGER, ((AstNode **) g_ast.nodes.data)[0]->kind);
+
+    Value v2 = eval("#($-5 + chr(66)) * (1 || 1 / 0)");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(3, v2.i);
+    ASSERT_EQ(AST_NODE_INTEGER, ((AstNode **) g_ast.nodes.data)[0]->kind);
+
+    /* division by zero is reported at runtime */
+    Value v3 = eval("(2 - 2) / 0 == 0");
+
+    ASSERT_EQ(TYPE_ERROR, v3.type->id);
+    ASSERT_EQ(AST_NODE_BINARY, ((AstNode **) g_ast.nodes.data)[0]->kind);
+
+    PASS();
+}
+
+TEST prune_dead_branches(void) {
+    run(
+        "int x = 1;"
+        "if (0) { x = 2; } else { x = 3; }"
+        "while (0 && x) { x = 4; }"
+        "if (\"a\" == \"a\") x = x * 10;"
+        "while (1) { if (x > 40) break; x++; }"
+    );
+
+    ASSERT_EQ(4, g_ast.nodes.len);
+    ASSERT_EQ(3, g_optimizer.pruned);
+
+    Value v = eval("x");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(41, v.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST inline_small_fns(void) {
+    run(
+        "int sq(int x) { return x * x; }"
+        "int is_digit(int ch) {"
+        "    return ch >= ord(\"0\") && ch <= ord(\"9\");"
+        "}"
+        "int first(string s) { return s[0]; }"
+        "int id(int x) { return x; }"
+        "int sub(int a, int b) { return b - a; }"
+        "int calls = 0;"
+        "int count() { calls++; return calls; }"
+        "void bump(int v) { v = v + 1; }"
+        "string s = \"a1b22\";"
+        "int digits = 0;"
+        "for (int i = 0; i < #s; i++) digits = digits + is_digit(s[i]);"
+        "int a = sq(3) + sq(digits);"
+        "int b = sq(count());"
+        "int c = first(s) == ord(\"a\");"
+        "[int] xs;"
+        "xs #= 2;"
+        "xs[1] = 5;"
+        "bump(id(xs[1]));"
+        "int d = sub(xs[0], xs[1]) * 10 + sub(1, 2);"
+    );
+
+    /* sub(xs[0], xs[1]) would evaluate xs[1] first */
+    ASSERT_EQ(6, g_optimizer.inlined);
+
+    Value v1 = eval("a * 100 + b * 10 + c");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(1811, v1.i);
+
+    Value v2 = eval("xs[1] * 100 + d");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(551, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
 TEST string_len(void) {
     Value v = eval("#\"Hello, World!\"");
 
@@ -587,7 +716,7 @@ TEST int_to_string(void) {
     Value v = eval("$115");
 
     ASSERT_EQ(TYPE_STRING, v.type->id);
-    ASSERT_STR_EQ("115", v.s->data);
+    ASSERT_STR_EQ("115", str_data(v.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -687,7 +816,7 @@ TEST string_var(void) {
     Value v = eval("s + s + \"String\"");
 
     ASSERT_EQ(TYPE_STRING, v.type->id);
-    ASSERT_STR_EQ("Hello, World!Hello, World!String", v.s->data);
+    ASSERT_STR_EQ("Hello, World!Hello, World!String", str_data(v.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -819,6 +948,59 @@ TEST option_nested(void) {
     PASS();
 }
 
+TEST option_inline_assign(void) {
+    run(
+        "int? a = 1;"
+        "*a = *a + 4;"
+        "string? s = \"ab\";"
+        "string? t = s;"
+        "*t = *t + \"c\";"
+        "[int] ys;"
+        "[int]? xs = ys;"
+        "*xs += 5;"
+        "int? e = nil;"
+        "int?? n = e;"
+        "[int?] opts;"
+        "opts #= 2;"
+        "opts[1] = 7;"
+        "*opts[1] = *opts[1] * 2;"
+        "int? b = 3;"
+    );
+
+    Value v1 = eval("*a * 100 + #*s * 10 + #*t");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(523, v1.i);
+
+    /* a present option holding an empty one */
+    Value v2 = eval("(n != nil) * 10 + (*n == nil)");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(11, v2.i);
+
+    Value v3 = eval("(opts[0] == nil) * 100 + *opts[1]");
+
+    ASSERT_EQ(TYPE_INT, v3.type->id);
+    ASSERT_EQ(114, v3.i);
+
+    Value v4 = eval("(a != b) * 10 + (a == b)");
+
+    ASSERT_EQ(TYPE_INT, v4.type->id);
+    ASSERT_EQ(10, v4.i);
+
+    Value v5 = eval("(*xs)[0] * 10 + #ys");
+
+    ASSERT_EQ(TYPE_INT, v5.type->id);
+    ASSERT_EQ(50, v5.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
 TEST option_clone(void) {
     run(
         "string? a = \"Hello\";"
@@ -829,12 +1011,12 @@ TEST option_clone(void) {
     Value v1 = eval("*a");
 
     ASSERT_EQ(TYPE_STRING, v1.type->id);
-    ASSERT_STR_EQ("Hello", v1.s->data);
+    ASSERT_STR_EQ("Hello", str_data(v1.s));
 
     Value v2 = eval("*b");
 
     ASSERT_EQ(TYPE_STRING, v2.type->id);
-    ASSERT_STR_EQ("Hello, World!", v2.s->data);
+    ASSERT_STR_EQ("Hello, World!", str_data(v2.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -855,17 +1037,17 @@ TEST option_nested_clone(void) {
     Value v1 = eval("*a");
 
     ASSERT_EQ(TYPE_STRING, v1.type->id);
-    ASSERT_STR_EQ("Hello", v1.s->data);
+    ASSERT_STR_EQ("Hello", str_data(v1.s));
 
     Value v2 = eval("**b");
 
     ASSERT_EQ(TYPE_STRING, v2.type->id);
-    ASSERT_STR_EQ("Hello", v2.s->data);
+    ASSERT_STR_EQ("Hello", str_data(v2.s));
 
     Value v3 = eval("***c");
 
     ASSERT_EQ(TYPE_STRING, v3.type->id);
-    ASSERT_STR_EQ("Hello, World!", v3.s->data);
+    ASSERT_STR_EQ("Hello, World!", str_data(v3.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -994,7 +1176,7 @@ TEST fn_return_string(void) {
     Value v = eval("foo()");
 
     ASSERT_EQ(TYPE_STRING, v.type->id);
-    ASSERT_STR_EQ("Hello, World!", v.s->data);
+    ASSERT_STR_EQ("Hello, World!", str_data(v.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -1039,15 +1221,17 @@ TEST fn_return_opt(void) {
     Value v1 = eval("foo(1)");
 
     ASSERT_EQ(TYPE_OPTION, v1.type->id);
-    ASSERT_NEQ(NULL, v1.opt.val);
+    ASSERT(value_opt_is_present(&v1));
+
+    Value inner = value_opt_get(&v1);
 
-    ASSERT_EQ(TYPE_INT, v1.opt.val->type->id);
-    ASSERT_EQ(115, v1.opt.val->i);
+    ASSERT_EQ(TYPE_INT, inner.type->id);
+    ASSERT_EQ(115, inner.i);
 
     Value v2 = eval("foo(0)");
 
     ASSERT_EQ(TYPE_OPTION, v2.type->id);
-    ASSERT_EQ(NULL, v2.opt.val);
+    ASSERT(!value_opt_is_present(&v2));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -1103,7 +1287,7 @@ TEST fn_with_multiple_params(void) {
     Value v = eval("concat(94, \"string\", o_i, \"option\")");
 
     ASSERT_EQ(TYPE_STRING, v.type->id);
-    ASSERT_STR_EQ("94, string, 115, option", v.s->data);
+    ASSERT_STR_EQ("94, string, 115, option", str_data(v.s));
 
     ASSERT_EQ(&g_ast, g_interp.ast);
     ASSERT_EQ(0, g_interp.exit_code);
@@ -1575,6 +1759,695 @@ TEST list_with_initial_size_iter(void) {
     PASS();
 }
 
+TEST int_list_resize(void) {
+    run(
+        "[int] list;"
+        "list #= 3;"
+        "list[2] = 7;"
+        "list -= 2;"
+        "list #= 4;"
+        "[int] copy = list;"
+        "copy[3] = 1;"
+        "[[int]] grid;"
+        "grid #= 2;"
+        "grid[1] += 9;"
+        "grid[1][0] = grid[1][0] + 1;"
+    );
+
+    /* popped elements don't come back when the list grows */
+    Value v1 = eval("list[0] + list[1] + list[2] + list[3]");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(0, v1.i);
+
+    Value v2 = eval("copy[3] * 10 + #copy");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(14, v2.i);
+
+    Value v3 = eval("grid[1][0] * 10 + #grid[0]");
+
+    ASSERT_EQ(TYPE_INT, v3.type->id);
+    ASSERT_EQ(100, v3.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST nested_break_continue(void) {
+    run(
+        "int sum = 0;"
+        "for (int i = 0; i < 10; ++i) {"
+        "  int j = 0;"
+        "  while (1) {"
+        "    { int k = j; if (k >= i) break; }"
+        "    ++j;"
+        "    if (j % 2 == 0) { continue; }"
+        "    sum = sum + j;"
+        "  }"
+        "}"
+    );
+
+    Value v = eval("sum");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(85, v.i);
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST shadowed_and_redeclared_vars(void) {
+    run(
+        "int x = 1;"
+        "int twice(int x) { int y = x; { int x = y * 2; y = x; } return y; }"
+        "{"
+        "  int x = 10;"
+        "  { int x = twice(x); x = x + 1; }"
+        "  string x = \"s\";"
+        "  x = x + \"t\";"
+        "}"
+        "int x = twice(x) + 40;"
+    );
+
+    Value v = eval("x");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(42, v.i);
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST deep_recursion(void) {
+    run(
+        "int g = 5;"
+        "int depth(int n) { if (n == 0) { return g; } return depth(n - 1) + 1; }"
+        "int a = depth(1000);"
+    );
+
+    Value v = eval("a");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(1005, v.i);
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST tail_recursion(void) {
+    run(
+        "int sum(int n, int acc) {"
+        "  if (n == 0) return acc;"
+        "  return sum(n - 1, acc + n);"
+        "}"
+        "int fill([int] xs, int n) {"
+        "  if (n == 0) return #xs;"
+        "  xs[n - 1] = n;"
+        "  return (fill(xs, n - 1));"
+        "}"
+        "int grow(string s, int n) {"
+        "  if (n == 0) return #s;"
+        "  { int k = n; return grow(s + \"x\", k - 1); }"
+        "}"
+        "[int] ys;"
+        "ys #= 5;"
+        "int a = sum(100000, 0);"
+        "int b = fill(ys, 5);"
+        "int c = grow(\"\", 100);"
+    );
+
+    Value v1 = eval("a");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(5000050000, v1.i);
+
+    /* the list is still passed by reference */
+    Value v2 = eval("b * 10000 + ys[0] * 1000 + ys[4] * 100 + c");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(51600, v2.i);
+
+    /* the frame of the first call was reused */
+    ASSERT(g_interp.frames.cap < 100);
+    ASSERT_EQ(0, g_interp.pinned.len);
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST tail_call_binds_like_call(void) {
+    run(
+        "int f(string s, int n) {"
+        "  if (n == 0) return #s;"
+        "  return f(s + \"x\", n - 1);"
+        "}"
+        "int g(string s, int n) {"
+        "  if (n == 0) return #s;"
+        "  int r = g(s + \"x\", n - 1);"
+        "  return r;"
+        "}"
+        "int h(string s, int n) {"
+        "  if (n == 0) { s[0] = 65; return #s; }"
+        "  return h(s, n - 1);"
+        "}"
+        "string a = \"a\";"
+        "a = a + \"b\";"
+        "string b = a;"
+        "b[0] = 97;"
+        "string c = a;"
+        "c[1] = 98;"
+        "int n = f(a, 3) * 100 + g(b, 3) * 10 + h(c, 3);"
+    );
+
+    Value v1 = eval("n");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(552, v1.i);
+
+    /* only h modifies the argument, through the borrowed parameter */
+    Value v2 = eval("a + \"|\" + b + \"|\" + c");
+
+    ASSERT_EQ(TYPE_STRING, v2.type->id);
+    ASSERT_STR_EQ("ab|ab|Ab", str_data(v2.s));
+
+    ASSERT_EQ(0, g_interp.pinned.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST build_string_in_loop(void) {
+    run(
+        "string s = \"\";"
+        "for (int i = 0; i < 5000; ++i) {"
+        "  s = s + \"ab\";"
+        "}"
+    );
+
+    Value v = eval("#s");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(10000, v.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST mutate_string_literal(void) {
+    run(
+        "string out = \"\";"
+        "void upper(string s) { s[0] = 65; }"
+        "for (int i = 0; i < 3; ++i) {"
+        "  string s = \"abc\";"
+        "  upper(s);"
+        "  out = out + s + \"abc\";"
+        "}"
+        "string t = \"xyz\";"
+        "t[1] = 89;"
+    );
+
+    Value v1 = eval("out");
+
+    ASSERT_EQ(TYPE_STRING, v1.type->id);
+    ASSERT_STR_EQ("AbcabcAbcabcAbcabc", str_data(v1.s));
+
+    Value v2 = eval("t");
+
+    ASSERT_EQ(TYPE_STRING, v2.type->id);
+    ASSERT_STR_EQ("xYz", str_data(v2.s));
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST concat_keeps_operands(void) {
+    run(
+        "string a = \"x\";"
+        "a[0] = 120;"
+        "string b = a + \"y\";"
+        "void g(string s) { string u = s + \"x\"; s = s + \"z\"; }"
+        "string c = \"a\";"
+        "c = c + \"b\";"
+        "g(c);"
+        "string d = c;"
+        "d = d + d;"
+        "for (int i = 0; i < 3; ++i) d = d + $i + \"-\";"
+    );
+
+    Value v1 = eval("a + \"|\" + b");
+
+    ASSERT_EQ(TYPE_STRING, v1.type->id);
+    ASSERT_STR_EQ("x|xy", str_data(v1.s));
+
+    Value v2 = eval("c + \"|\" + d");
+
+    ASSERT_EQ(TYPE_STRING, v2.type->id);
+    ASSERT_STR_EQ("ab|abab0-1-2-", str_data(v2.s));
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST copy_on_write(void) {
+    run(
+        "[[int]] grid;"
+        "for (int i = 0; i < 3; ++i) { [int] row; row #= 3; grid += row; }"
+        "[[int]] copy = grid;"
+        "copy[1][2] = 7;"
+        "void set([int] xs) { [int] ys = xs; xs[0] = 9; ys[1] = 5; }"
+        "set(grid[2]);"
+        "[string] names;"
+        "names += \"x\";"
+        "[string] names2 = names;"
+        "names2[0][0] = 65;"
+    );
+
+    Value v1 = eval("grid[1][2] * 10 + copy[1][2]");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(7, v1.i);
+
+    Value v2 = eval("grid[2][0] * 100 + grid[2][1] * 10 + copy[2][0]");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(900, v2.i);
+
+    Value v3 = eval("names[0] + names2[0]");
+
+    ASSERT_EQ(TYPE_STRING, v3.type->id);
+    ASSERT_STR_EQ("xA", str_data(v3.s));
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST release_temporaries(void) {
+    ArenaStats before = rc_stats();
+
+    run(
+        "[int] range(int n) { [int] xs; for (int i = 0; i < n; ++i) { xs += i; } return xs; }"
+        "string s = \"\";"
+        "int sum = 0;"
+        "for (int i = 0; i < 1000; ++i) {"
+        "  s = $i + \"-\" + $(i + 1);"
+        "  sum = sum + #range(i % 5) + #s;"
+        "}"
+    );
+
+    /* Every statement has released its temporaries */
+    ASSERT_EQ(0, g_interp.temps.len);
+
+    /* Only the variables and literals hold objects */
+    ArenaStats after = rc_stats();
+    ASSERT(after.allocs - after.frees < before.allocs - before.frees + 8);
+
+    Value v1 = eval("s");
+
+    ASSERT_EQ(TYPE_STRING, v1.type->id);
+    ASSERT_STR_EQ("999-1000", str_data(v1.s));
+
+    Value v2 = eval("sum");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(2000 + 9 * 3 + 4 + 89 * 5 + 6 + 899 * 7 + 8, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST return_from_nested_loop(void) {
+    run(
+        "int find(int n) {"
+        "  for (int i = 0; i < 100; ++i) {"
+        "    int j = 0;"
+        "    while (j < i) {"
+        "      if (i * j == n) { return i + j; }"
+        "      ++j;"
+        "    }"
+        "  }"
+        "  return -1;"
+        "}"
+        "int a = find(42);"
+        "int b = find(-5);"
+    );
+
+    Value v1 = eval("a");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(13, v1.i);
+
+    Value v2 = eval("b");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(-1, v2.i);
+    ASSERT_EQ(1, g_interp.env.scopes.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST map_insert_lookup_remove(void) {
+    run(
+        "map<string, int> m;"
+        "m[\"a\"] = 1;"
+        "m[\"b\"] = 2;"
+        "m[\"c\"] = 3;"
+        "m[\"b\"] = nil;"
+        "*m[\"c\"] = *m[\"c\"] + 10;"
+        "int? x = m[\"b\"];"
+    );
+
+    Value v1 = eval("#m * 100 + *m[\"a\"] * 10 + (x == nil)");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(211, v1.i);
+
+    Value v2 = eval("*m[\"c\"]");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(13, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST map_for_each(void) {
+    run(
+        "map<int, int> sq;"
+        "for (int i = 0; i < 100; ++i) { sq[i] = i * i; }"
+        "int sum = 0;"
+        "for (int k : sq) {"
+        "  if (k % 2 == 0) { continue; }"
+        "  sum = sum + *sq[k];"
+        "  sq[k] = nil;"
+        "}"
+    );
+
+    Value v1 = eval("sum");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(166650, v1.i);
+
+    Value v2 = eval("#sq");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(50, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST map_copy_on_write(void) {
+    run(
+        "void bump(map<string, int> m) { m[\"z\"] = 26; }"
+        "map<string, int> m;"
+        "m[\"a\"] = 1;"
+        "map<string, int> copy = m;"
+        "bump(copy);"
+        "copy[\"a\"] = 100;"
+    );
+
+    Value v1 = eval("#m * 10 + #copy");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(12, v1.i);
+
+    Value v2 = eval("*m[\"a\"] + *copy[\"a\"] + *copy[\"z\"]");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(127, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST struct_copy_on_write(void) {
+    run(
+        "struct Point { int x; int y; }"
+        "struct Body { Point pos; [int] trail; }"
+        "Body a;"
+        "a.pos.x = 3;"
+        "a.trail += 1;"
+        "Body b = a;"
+        "b.pos.x = 10;"
+        "b.trail += 2;"
+        "b.pos.y++;"
+    );
+
+    Value v1 = eval("a.pos.x * 100 + b.pos.x * 10 + b.pos.y");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(401, v1.i);
+
+    Value v2 = eval("#a.trail * 10 + #b.trail");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(12, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST struct_list_inline(void) {
+    run(
+        "struct Car { string name; int laps; }"
+        "[Car] cars;"
+        "cars #= 2;"
+        "cars[0].name = \"a\";"
+        "cars[1].laps = 5;"
+        "Car c = cars[1];"
+        "c.laps = 7;"
+        "cars += c;"
+        "cars[0] = cars[2];"
+        "cars[2].laps++;"
+        "[Car] copy = cars;"
+        "copy -= 1;"
+        "copy[0].laps = 1;"
+    );
+
+    Value v1 = eval("cars[0].laps * 100 + cars[1].laps * 10 + cars[2].laps");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(758, v1.i);
+
+    Value v2 = eval("#cars * 10 + #copy + copy[0].laps * 100");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(132, v2.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST struct_pass_by_ref(void) {
+    run(
+        "struct Point { int x; }"
+        "void bump(Point p) { p.x = p.x + 1; }"
+        "Point p;"
+        "[Point] ps;"
+        "ps #= 1;"
+        "bump(p);"
+        "bump(p);"
+        "bump(ps[0]);"
+    );
+
+    /* elements of a list of structs are passed by copy */
+    Value v = eval("p.x * 10 + ps[0].x");
+
+    ASSERT_EQ(TYPE_INT, v.type->id);
+    ASSERT_EQ(20, v.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST option_pass_by_ref(void) {
+    run(
+        "int? p = 1;"
+        "int? e = 3;"
+        "[int?] os;"
+        "os += e;"
+        "os += e;"
+        "void set(int? o) { *o = 42; }"
+        "void grow(int? o) {"
+        "  int? n = 0;"
+        "  int i = 0;"
+        "  while (i < 100) { os += n; i = i + 1; }"
+        "  *o = 7;"
+        "}"
+        "set(p);"
+        "set(os[0]);"
+        "grow(os[1]);"
+    );
+
+    Value v1 = eval("*p");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(42, v1.i);
+
+    Value v2 = eval("*os[0]");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(42, v2.i);
+
+    /* the list has grown while the element was referenced */
+    Value v3 = eval("*os[1]");
+
+    ASSERT_EQ(TYPE_INT, v3.type->id);
+    ASSERT_EQ(7, v3.i);
+
+    ASSERT_EQ(0, g_interp.pinned.len);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST string_slices(void) {
+    run(
+        "string s = \"the quick brown fox jumps over the lazy dog\";"
+        "string tail = s[4:];"
+        "string word = tail[6:11];"
+        "tail[0] = 81;"
+    );
+
+    /* slices aren't null terminated */
+    Value v1 = eval("word");
+
+    ASSERT_EQ(TYPE_STRING, v1.type->id);
+    ASSERT_EQ(5, str_len(v1.s));
+    ASSERT_EQ(0, strncmp("brown", str_data(v1.s), 5));
+
+    Value v2 = eval("s[:9] + \"|\" + tail[:5] + \"|\" + s[40:]");
+
+    ASSERT_EQ(TYPE_STRING, v2.type->id);
+    ASSERT_STR_EQ("the quick|Quick|dog", str_data(v2.s));
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
+TEST list_slices(void) {
+    run(
+        "[int] xs;"
+        "for (int i = 0; i < 10; ++i) { xs += i; }"
+        "[int] mid = xs[3:7];"
+        "[int] inner = mid[1:3];"
+        "mid[0] = 100;"
+        "mid += 7;"
+        "[[int]] rows;"
+        "rows #= 3;"
+        "[[int]] last = rows[1:];"
+        "last[1] += 5;"
+    );
+
+    Value v1 = eval("xs[3] * 1000 + mid[0] * 10 + inner[0]");
+
+    ASSERT_EQ(TYPE_INT, v1.type->id);
+    ASSERT_EQ(4004, v1.i);
+
+    Value v2 = eval("#xs * 100 + #mid * 10 + #inner");
+
+    ASSERT_EQ(TYPE_INT, v2.type->id);
+    ASSERT_EQ(1052, v2.i);
+
+    Value v3 = eval("#rows[2] * 10 + #last[1]");
+
+    ASSERT_EQ(TYPE_INT, v3.type->id);
+    ASSERT_EQ(1, v3.i);
+
+    ASSERT_EQ(&g_ast, g_interp.ast);
+    ASSERT_EQ(0, g_interp.exit_code);
+    ASSERT_EQ(false, g_interp.had_error);
+    ASSERT_EQ(false, g_interp.halt);
+
+    PASS();
+}
+
 SUITE(valid) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -1617,6 +2490,10 @@ SUITE(valid) {
     RUN_TEST(or_2_true);
     RUN_TEST(or_3_true);
     RUN_TEST(or_false);
+    RUN_TEST(short_circuit);
+    RUN_TEST(fold_constants);
+    RUN_TEST(prune_dead_branches);
+    RUN_TEST(inline_small_fns);
     RUN_TEST(string_len);
     RUN_TEST(int_to_string);
     RUN_TEST(string_subscript);
@@ -1633,6 +2510,7 @@ SUITE(valid) {
     RUN_TEST(option_deref_assign);
     RUN_TEST(option_assign_nil);
     RUN_TEST(option_nested);
+    RUN_TEST(option_inline_assign);
     RUN_TEST(option_clone);
     RUN_TEST(option_nested_clone);
     RUN_TEST(option_compare_not_equal);
@@ -1670,4 +2548,25 @@ SUITE(valid) {
     RUN_TEST(list_pop);
     RUN_TEST(list_iter);
     RUN_TEST(list_with_initial_size_iter);
+    RUN_TEST(int_list_resize);
+    RUN_TEST(nested_break_continue);
+    RUN_TEST(return_from_nested_loop);
+    RUN_TEST(shadowed_and_redeclared_vars);
+    RUN_TEST(deep_recursion);
+    RUN_TEST(tail_recursion);
+    RUN_TEST(tail_call_binds_like_call);
+    RUN_TEST(build_string_in_loop);
+    RUN_TEST(mutate_string_literal);
+    RUN_TEST(concat_keeps_operands);
+    RUN_TEST(copy_on_write);
+    RUN_TEST(release_temporaries);
+    RUN_TEST(map_insert_lookup_remove);
+    RUN_TEST(map_for_each);
+    RUN_TEST(map_copy_on_write);
+    RUN_TEST(struct_copy_on_write);
+    RUN_TEST(struct_list_inline);
+    RUN_TEST(struct_pass_by_ref);
+    RUN_TEST(option_pass_by_ref);
+    RUN_TEST(string_slices);
+    RUN_TEST(list_slices);
 }
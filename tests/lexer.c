@@ -186,7 +186,7 @@ TEST identifiers_separated_with_whitespace(void) {
 }
 
 TEST single_operators(void) {
-    const char *input = "=,;+-/%()[]{}$#?!<>";
+    const char *input = "=,;+-/%()[]{}$#?!<>:.";
     lexer_lex(input, strlen(input), &g_tokens);
 
     ASSERT_EQ(strlen(input) + 1, g_tokens.len);
@@ -211,7 +211,9 @@ TEST single_operators(void) {
         {TOKEN_EXCL, input + 16, 1, true, {1, 17}},
         {TOKEN_LESS, input + 17, 1, true, {1, 18}},
         {TOKEN_GREATER, input + 18, 1, true, {1, 19}},
-        {TOKEN_EOF, input + strlen(input), 0, true, {1, 20}}
+        {TOKEN_COLON, input + 19, 1, true, {1, 20}},
+        {TOKEN_DOT, input + 20, 1, true, {1, 21}},
+        {TOKEN_EOF, input + strlen(input), 0, true, {1, 22}}
     };
 
     for (int i = 0; i < g_tokens.len; ++i) {
@@ -468,10 +470,10 @@ TEST embedded_strings(void) {
 
 TEST keywords(void) {
     const char *input = "if else for while return break continue nil int void "
-                        "string";
+                        "string map struct";
     lexer_lex(input, strlen(input), &g_tokens);
 
-    ASSERT_EQ(12, g_tokens.len);
+    ASSERT_EQ(14, g_tokens.len);
 
     Token expected[] = {
         {TOKEN_IF, input, 2, true, {1, 1}},
@@ -485,7 +487,9 @@ TEST keywords(void) {
         {TOKEN_INT, input + 44, 3, true, {1, 45}},
         {TOKEN_VOID, input + 48, 4, true, {1, 49}},
         {TOKEN_STRING, input + 53, 6, true, {1, 54}},
-        {TOKEN_EOF, input + strlen(input), 0, true, {1, 60}}
+        {TOKEN_MAP, input + 60, 3, true, {1, 61}},
+        {TOKEN_STRUCT, input + 64, 6, true, {1, 65}},
+        {TOKEN_EOF, input + strlen(input), 0, true, {1, 71}}
     };
 
     for (int i = 0; i < g_tokens.len; ++i) {
@@ -154,6 +154,36 @@ TEST_STRING_AGAINST_FILE(
     "fn-decl-with-missing-comma.txt"
 )
 
+TEST_STRING_AGAINST_FILE(
+    map_decl_with_missing_value_type,
+    "map<int> m;",
+    "map-decl-with-missing-value-type.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    for_each_with_missing_expr,
+    "for (int i : ) {}",
+    "for-each-with-missing-expr.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    struct_decl_without_fields,
+    "struct P { }",
+    "struct-decl-without-fields.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    field_access_with_missing_name,
+    "p.;",
+    "field-access-with-missing-name.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    slice_with_missing_rbracket,
+    "s[1:;",
+    "slice-with-missing-rbracket.txt"
+)
+
 SUITE(SUITE_NAME) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -190,4 +220,9 @@ SUITE(SUITE_NAME) {
     RUN_TEST(fn_decl_with_bad_param_name);
     RUN_TEST(fn_decl_with_bad_param_type);
     RUN_TEST(fn_decl_with_missing_comma);
+    RUN_TEST(map_decl_with_missing_value_type);
+    RUN_TEST(for_each_with_missing_expr);
+    RUN_TEST(struct_decl_without_fields);
+    RUN_TEST(field_access_with_missing_name);
+    RUN_TEST(slice_with_missing_rbracket);
 }
@@ -361,6 +361,38 @@ TEST_STRING_AGAINST_FILE(
     "fn-decl-with-more-statements.txt"
 )
 
+TEST_STRING_AGAINST_FILE(
+    map_decl, "map<string, [int]?> scores;", "map-decl.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    nested_map_decl, "map<int, map<string, int>> m;", "nested-map-decl.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    for_each, "for (string k : m) println(k);", "for-each.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    struct_decl, "struct Point { int x; [int] ys; }", "struct-decl.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    struct_var_decl, "Point p; [Point] ps; Point? o;", "struct-var-decl.txt"
+)
+
+TEST_STRING_AGAINST_FILE(
+    field_access, "p.pos.x = ps[0].y;", "field-access.txt"
+)
+
+TEST_STRING_AGAINST_FILE(slice, "s[1:3];", "slice.txt")
+
+TEST_STRING_AGAINST_FILE(
+    slice_without_bounds,
+    "xs[:n]; t[i + 1:]; u[:];",
+    "slice-without-bounds.txt"
+)
+
 SUITE(SUITE_NAME) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -421,4 +453,12 @@ SUITE(SUITE_NAME) {
     RUN_TEST(fn_decl_empty_body);
     RUN_TEST(fn_decl_with_1_statement);
     RUN_TEST(fn_decl_with_more_statements);
+    RUN_TEST(map_decl);
+    RUN_TEST(nested_map_decl);
+    RUN_TEST(for_each);
+    RUN_TEST(struct_decl);
+    RUN_TEST(struct_var_decl);
+    RUN_TEST(field_access);
+    RUN_TEST(slice);
+    RUN_TEST(slice_without_bounds);
 }
@@ -212,6 +212,15 @@ TEST undeclared_variable(void) {
     PASS();
 }
 
+TEST fn_cannot_see_enclosing_block(void) {
+    CHECK_FAIL("{ int x = 1; int foo() { return x; } }");
+
+    ASSERT_EQ(DIAGNOSTIC_UNDECLARED_VARIABLE, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ("x", NTH_DMSG(0).undef_sym.name);
+
+    PASS();
+}
+
 TEST param_redecl(void) {
     CHECK_FAIL("int foo(int a, int b, int a) { return a + b + c; }");
 
@@ -423,6 +432,125 @@ TEST continue_must_be_inside_loop(void) {
     PASS();
 }
 
+TEST map_bad_key_type(void) {
+    CHECK_FAIL("map<[int], int> m;");
+
+    ASSERT_EQ(DIAGNOSTIC_BAD_MAP_KEY_TYPE, NTH_DMSG(0).kind);
+    ASSERT_EQ(TYPE_LIST, NTH_DMSG(0).bad_index_type.found->id);
+    ASSERT_STR_EQ(
+        "map key must be int or string, but found list<int>",
+        dmsg_to_str(&NTH_DMSG(0))
+    );
+
+    PASS();
+}
+
+TEST map_sub_bad_key_type(void) {
+    CHECK_FAIL("map<string, int> m; m[0];");
+
+    ASSERT_EQ(DIAGNOSTIC_MISMATCHED_TYPES, NTH_DMSG(0).kind);
+
+    PASS();
+}
+
+TEST for_each_over_non_map(void) {
+    CHECK_FAIL("[int] xs; for (int x : xs) {}");
+
+    ASSERT_EQ(DIAGNOSTIC_EXPECTED_MAP, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ(
+        "expected map, but found list<int>",
+        dmsg_to_str(&NTH_DMSG(0))
+    );
+
+    PASS();
+}
+
+TEST struct_redefinition(void) {
+    CHECK_FAIL("struct P { int x; } struct P { int y; }");
+
+    ASSERT_EQ(DIAGNOSTIC_STRUCT_REDEFINITION, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ("struct P is already defined", dmsg_to_str(&NTH_DMSG(0)));
+
+    PASS();
+}
+
+TEST struct_cannot_contain_itself(void) {
+    CHECK_FAIL("struct P { int x; P next; }");
+
+    ASSERT_EQ(DIAGNOSTIC_RECURSIVE_STRUCT, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ(
+        "struct P cannot contain itself", dmsg_to_str(&NTH_DMSG(0))
+    );
+
+    PASS();
+}
+
+TEST struct_must_be_global(void) {
+    CHECK_FAIL("void f() { struct P { int x; } }");
+
+    ASSERT_EQ(DIAGNOSTIC_STRUCT_BAD_PLACE, NTH_DMSG(0).kind);
+
+    PASS();
+}
+
+TEST struct_field_redeclaration(void) {
+    CHECK_FAIL("struct P { int x; string x; }");
+
+    ASSERT_EQ(DIAGNOSTIC_FIELD_REDECLARATION, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ("field x is already declared", dmsg_to_str(&NTH_DMSG(0)));
+
+    PASS();
+}
+
+TEST unknown_struct_type(void) {
+    CHECK_FAIL("Q q;");
+
+    ASSERT_EQ(DIAGNOSTIC_UNKNOWN_TYPE, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ("unknown type Q", dmsg_to_str(&NTH_DMSG(0)));
+
+    PASS();
+}
+
+TEST no_such_field(void) {
+    CHECK_FAIL("struct P { int x; } P p; p.y = 1;");
+
+    ASSERT_EQ(DIAGNOSTIC_NO_SUCH_FIELD, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ("struct P has no field y", dmsg_to_str(&NTH_DMSG(0)));
+
+    PASS();
+}
+
+TEST field_of_non_struct(void) {
+    CHECK_FAIL("int a; a.x;");
+
+    ASSERT_EQ(DIAGNOSTIC_EXPECTED_STRUCT, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ(
+        "expected struct, but found int", dmsg_to_str(&NTH_DMSG(0))
+    );
+
+    PASS();
+}
+
+TEST slice_of_map(void) {
+    CHECK_FAIL("map<int, int> m; m[1:2];");
+
+    ASSERT_EQ(DIAGNOSTIC_EXPR_NOT_INDEXABLE, NTH_DMSG(0).kind);
+
+    PASS();
+}
+
+TEST slice_bad_bound_type(void) {
+    CHECK_FAIL("string s; s[\"a\":];");
+
+    ASSERT_EQ(DIAGNOSTIC_BAD_INDEX_TYPE, NTH_DMSG(0).kind);
+    ASSERT_STR_EQ(
+        "index expression must result in int, but found string",
+        dmsg_to_str(&NTH_DMSG(0))
+    );
+
+    PASS();
+}
+
 SUITE(invalid) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -440,6 +568,7 @@ SUITE(invalid) {
     RUN_TEST(unary_string);
     RUN_TEST(var_decl);
     RUN_TEST(undeclared_variable);
+    RUN_TEST(fn_cannot_see_enclosing_block);
     RUN_TEST(param_redecl);
     RUN_TEST(fn_call_too_many_arguments);
     RUN_TEST(fn_call_too_few_arguments);
@@ -456,4 +585,16 @@ SUITE(invalid) {
     RUN_TEST(return_must_be_inside_fn);
     RUN_TEST(break_must_be_inside_loop);
     RUN_TEST(continue_must_be_inside_loop);
+    RUN_TEST(map_bad_key_type);
+    RUN_TEST(map_sub_bad_key_type);
+    RUN_TEST(for_each_over_non_map);
+    RUN_TEST(struct_redefinition);
+    RUN_TEST(struct_cannot_contain_itself);
+    RUN_TEST(struct_must_be_global);
+    RUN_TEST(struct_field_redeclaration);
+    RUN_TEST(unknown_struct_type);
+    RUN_TEST(no_such_field);
+    RUN_TEST(field_of_non_struct);
+    RUN_TEST(slice_of_map);
+    RUN_TEST(slice_bad_bound_type);
 }
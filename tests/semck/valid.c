@@ -163,6 +163,44 @@ CHECK_EXPR(
     "println($i);"
 )
 
+CHECK_EXPR(
+    map_insert_lookup,
+    "map<string, int> m;"
+    "m[\"a\"] = 1;"
+    "int? x = m[\"a\"];"
+    "m[\"a\"] = nil;"
+    "println($#m);"
+)
+
+CHECK_EXPR(
+    map_for_each,
+    "map<int, [string]> m;"
+    "for (int k : m) {"
+    "  println($k);"
+    "}"
+)
+
+CHECK_EXPR(
+    struct_fields,
+    "struct Point { int x; int y; }"
+    "struct Body { Point pos; [Point] trail; string? name; }"
+    "Body b;"
+    "b.pos.x = 1;"
+    "b.trail += b.pos;"
+    "b.trail[0].y++;"
+    "println($(b.pos.x + b.trail[0].y));"
+)
+
+CHECK_EXPR(
+    slices,
+    "string s = \"hello\";"
+    "[[int]] xs;"
+    "string t = s[1:#s - 1];"
+    "[[int]] ys = xs[:2];"
+    "ys[0] = xs[1][1:];"
+    "println(s[:] + t[1:]);"
+)
+
 SUITE(valid) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -212,4 +250,8 @@ SUITE(valid) {
     RUN_TEST(for_stmt);
     RUN_TEST(for_decl_clause);
     RUN_TEST(for_decl_clause_shadow);
+    RUN_TEST(map_insert_lookup);
+    RUN_TEST(map_for_each);
+    RUN_TEST(struct_fields);
+    RUN_TEST(slices);
 }
@@ -0,0 +1,223 @@
+#include <monolog/strbuf.h>
+
+#include <greatest.h>
+
+#include <string.h>
+
+static StrBuf g_str;
+
+void set_up(void *udata) {
+    (void) udata;
+
+    str_init(&g_str);
+}
+
+void tear_down(void *udata) {
+    (void) udata;
+
+    str_deinit(&g_str);
+}
+
+TEST empty_str(void) {
+    ASSERT_EQ(0, str_len(&g_str));
+    ASSERT(str_is_inline(&g_str));
+    ASSERT_STR_EQ("", str_data(&g_str));
+
+    PASS();
+}
+
+TEST cat_strings(void) {
+    StrBuf other;
+    str_dup(&other, "abc");
+
+    str_cat(&g_str, &other);
+    str_cat(&g_str, &other);
+
+    ASSERT_EQ(6, str_len(&g_str));
+    ASSERT(str_cap(&g_str) >= str_len(&g_str));
+    ASSERT_STR_EQ("abcabc", str_data(&g_str));
+
+    str_deinit(&other);
+
+    PASS();
+}
+
+TEST cat_grows_geometrically(void) {
+    StrBuf other;
+    str_dup(&other, "x");
+
+    size_t reallocs = 0;
+    size_t cap = str_cap(&g_str);
+
+    for (int i = 0; i < 1000; ++i) {
+        str_cat(&g_str, &other);
+
+        if (str_cap(&g_str) != cap) {
+            cap = str_cap(&g_str);
+            ++reallocs;
+        }
+    }
+
+    ASSERT_EQ(1000, str_len(&g_str));
+    ASSERT(reallocs < 16);
+
+    str_deinit(&other);
+
+    PASS();
+}
+
+TEST reserve(void) {
+    str_set_cstr(&g_str, "hello");
+    str_reserve(&g_str, 100);
+
+    ASSERT_EQ(100, str_cap(&g_str));
+    ASSERT_EQ(5, str_len(&g_str));
+    ASSERT_STR_EQ("hello", str_data(&g_str));
+
+    /* never shrinks */
+    str_reserve(&g_str, 10);
+
+    ASSERT_EQ(100, str_cap(&g_str));
+
+    PASS();
+}
+
+TEST shrink(void) {
+    str_reserve(&g_str, 100);
+    str_set_cstr(&g_str, "a string longer than the inline buffer");
+    str_shrink(&g_str);
+
+    ASSERT_EQ(38, str_cap(&g_str));
+    ASSERT_EQ(38, str_len(&g_str));
+    ASSERT_STR_EQ("a string longer than the inline buffer", str_data(&g_str));
+
+    PASS();
+}
+
+TEST shrink_to_inline(void) {
+    str_reserve(&g_str, 100);
+    str_set_cstr(&g_str, "hello");
+    str_shrink(&g_str);
+
+    ASSERT(str_is_inline(&g_str));
+    ASSERT_EQ(STRBUF_SSO_CAP, str_cap(&g_str));
+    ASSERT_STR_EQ("hello", str_data(&g_str));
+
+    PASS();
+}
+
+TEST short_str_is_inline(void) {
+    char cstr[STRBUF_SSO_CAP + 2];
+    memset(cstr, 'x', sizeof(cstr) - 1);
+    cstr[STRBUF_SSO_CAP] = '\0';
+
+    StrBuf str;
+    str_dup(&str, cstr);
+
+    ASSERT(str_is_inline(&str));
+    ASSERT_EQ(STRBUF_SSO_CAP, str_len(&str));
+
+    str_deinit(&str);
+    cstr[STRBUF_SSO_CAP] = 'x';
+    cstr[STRBUF_SSO_CAP + 1] = '\0';
+    str_dup(&str, cstr);
+
+    ASSERT(!str_is_inline(&str));
+    ASSERT_EQ(STRBUF_SSO_CAP + 1, str_len(&str));
+
+    str_deinit(&str);
+
+    PASS();
+}
+
+TEST inline_str_is_movable(void) {
+    ASSERT_EQ(sizeof(char *) + 2 * sizeof(size_t), sizeof(StrBuf));
+
+    str_set_cstr(&g_str, "hello");
+
+    StrBuf moved = g_str;
+    str_init(&g_str);
+
+    ASSERT_EQ(5, str_len(&moved));
+    ASSERT_STR_EQ("hello", str_data(&moved));
+
+    str_deinit(&moved);
+
+    PASS();
+}
+
+TEST cat_moves_out_of_inline(void) {
+    StrBuf other;
+    str_dup(&other, "0123456789");
+
+    str_cat(&g_str, &other);
+
+    ASSERT(str_is_inline(&g_str));
+
+    str_cat(&g_str, &other);
+    str_cat(&g_str, &other);
+
+    ASSERT(!str_is_inline(&g_str));
+    ASSERT_EQ(30, str_len(&g_str));
+    ASSERT_STR_EQ("012345678901234567890123456789", str_data(&g_str));
+
+    str_deinit(&other);
+
+    PASS();
+}
+
+TEST set_cstr_reuses_buffer(void) {
+    str_set_cstr(&g_str, "a long string to set");
+    size_t cap = str_cap(&g_str);
+
+    str_set_cstr(&g_str, "short");
+
+    ASSERT_EQ(cap, str_cap(&g_str));
+    ASSERT_EQ(5, str_len(&g_str));
+    ASSERT_STR_EQ("short", str_data(&g_str));
+
+    PASS();
+}
+
+TEST resize(void) {
+    str_set_cstr(&g_str, "hello");
+    str_resize(&g_str, 8);
+
+    ASSERT_EQ(8, str_len(&g_str));
+    ASSERT_STR_EQ("hello", str_data(&g_str));
+    ASSERT_EQ('\0', str_data(&g_str)[7]);
+
+    str_resize(&g_str, 2);
+
+    ASSERT_EQ(2, str_len(&g_str));
+    ASSERT_STR_EQ("he", str_data(&g_str));
+
+    PASS();
+}
+
+SUITE(strbuf) {
+    GREATEST_SET_SETUP_CB(set_up, NULL);
+    GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
+
+    RUN_TEST(empty_str);
+    RUN_TEST(cat_strings);
+    RUN_TEST(cat_grows_geometrically);
+    RUN_TEST(reserve);
+    RUN_TEST(shrink);
+    RUN_TEST(shrink_to_inline);
+    RUN_TEST(short_str_is_inline);
+    RUN_TEST(inline_str_is_movable);
+    RUN_TEST(cat_moves_out_of_inline);
+    RUN_TEST(set_cstr_reuses_buffer);
+    RUN_TEST(resize);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char *argv[]) {
+    GREATEST_MAIN_BEGIN();
+
+    RUN_SUITE(strbuf);
+
+    GREATEST_MAIN_END();
+}
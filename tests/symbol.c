@@ -0,0 +1,88 @@
+#include <monolog/arena.h>
+#include <monolog/symbol.h>
+
+#include <greatest.h>
+
+#include <string.h>
+
+void tear_down(void *udata) {
+    (void) udata;
+
+    sym_table_deinit();
+}
+
+TEST equal_names_share_symbol(void) {
+    const char *src = "foo bar foo";
+
+    Symbol foo = sym_intern(src, 3);
+    Symbol bar = sym_intern(src + 4, 3);
+
+    ASSERT_STR_EQ("foo", foo);
+    ASSERT_STR_EQ("bar", bar);
+    ASSERT(foo != bar);
+    ASSERT_EQ(foo, sym_intern(src + 8, 3));
+    ASSERT_EQ(foo, sym_intern_cstr("foo"));
+    ASSERT(foo != sym_intern_cstr("fo"));
+
+    PASS();
+}
+
+TEST empty_name(void) {
+    Symbol sym = sym_intern("", 0);
+
+    ASSERT_STR_EQ("", sym);
+    ASSERT_EQ(sym, sym_intern_cstr(""));
+
+    PASS();
+}
+
+TEST long_name(void) {
+    char name[ARENA_MAX_SIZE * 2 + 1];
+    memset(name, 'x', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+
+    Symbol sym = sym_intern(name, sizeof(name) - 1);
+
+    ASSERT_STR_EQ(name, sym);
+    ASSERT_EQ(sym, sym_intern_cstr(name));
+
+    PASS();
+}
+
+TEST many_names(void) {
+    Symbol syms[1000];
+    char name[16];
+
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "name%d", i);
+        syms[i] = sym_intern_cstr(name);
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(name, sizeof(name), "name%d", i);
+
+        ASSERT_STR_EQ(name, syms[i]);
+        ASSERT_EQ(syms[i], sym_intern_cstr(name));
+    }
+
+    PASS();
+}
+
+SUITE(symbol) {
+    GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
+
+    RUN_TEST(equal_names_share_symbol);
+    RUN_TEST(empty_name);
+    RUN_TEST(long_name);
+    RUN_TEST(many_names);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char *argv[]) {
+    GREATEST_MAIN_BEGIN();
+
+    RUN_SUITE(symbol);
+
+    GREATEST_MAIN_END();
+}
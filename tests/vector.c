@@ -147,6 +147,25 @@ TEST capacity_remains_the_same_after_clearing(void) {
     PASS();
 }
 
+TEST reserve(void) {
+    int x = 115;
+    vec_push(&g_vec, &x);
+
+    vec_reserve(&g_vec, VECTOR_DEFAULT_CAP * 3);
+
+    ASSERT_EQ(VECTOR_DEFAULT_CAP * 3, g_vec.cap);
+    ASSERT_EQ(1, g_vec.len);
+    ASSERT_EQ(115, NTH_VALUE(0));
+    ASSERT_EQ(0, NTH_VALUE(VECTOR_DEFAULT_CAP * 3 - 1));
+
+    /* never shrinks */
+    vec_reserve(&g_vec, 1);
+
+    ASSERT_EQ(VECTOR_DEFAULT_CAP * 3, g_vec.cap);
+
+    PASS();
+}
+
 SUITE(vector) {
     GREATEST_SET_SETUP_CB(set_up, NULL);
     GREATEST_SET_TEARDOWN_CB(tear_down, NULL);
@@ -159,6 +178,7 @@ SUITE(vector) {
     RUN_TEST(pop_50_values);
     RUN_TEST(capacity_remains_the_same_after_popping_all);
     RUN_TEST(capacity_remains_the_same_after_clearing);
+    RUN_TEST(reserve);
 }
 
 GREATEST_MAIN_DEFS();